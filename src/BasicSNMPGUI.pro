@@ -27,6 +27,11 @@ CONFIG += c++11
 SOURCES += \
 		lib/asn1encoder.cpp \
 		lib/snmpencoder.cpp \
+		lib/asn1writer.cpp \
+		lib/requesttemplate.cpp \
+		lib/messageview.cpp \
+		lib/snapshot.cpp \
+		lib/oidregistry.cpp \
 		snmptests.cpp \
 		qsnmpconn.cpp \
 		qconstantsstrings.cpp \
@@ -37,15 +42,29 @@ SOURCES += \
 HEADERS += \
 		lib/snmplib.h \
 		lib/asn1types.h \
+		lib/asn1typetable.h \
 		lib/snmptable.h \
+		lib/columntable.h \
+		lib/snapshot.h \
 		lib/stdcharvector.h \
 		lib/stdlist.h \
 		lib/oid.h \
+		lib/compactoid.h \
+		lib/oidregistry.h \
+		lib/oidprefixtree.h \
+		lib/textwriter.h \
 		lib/asn1variable.h \
 		lib/stdvector.h \
 		lib/pduvarbind.h \
+		lib/rawvalue.h \
 		lib/asn1encoder.h \
+		lib/asn1writer.h \
 		lib/snmpencoder.h \
+		lib/requesttemplate.h \
+		lib/messageview.h \
+		lib/byteview.h \
+		lib/allocator.h \
+		lib/arena.h \
 		lib/types.h \
 		lib/stdstring.h \
 		lib/basic_types.h \
@@ -0,0 +1,132 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#include "basic_types.h"
+
+namespace SNMP {
+
+/*
+ * Source of memory for the library containers. Like std::pmr::memory_resource,
+ * but C++11 friendly.
+ * Derive from it to use pools, arenas, huge pages and so on.
+ */
+class MemoryResource
+{
+public:
+	virtual ~MemoryResource() = default;
+	// alignment is allways a power of 2.
+	virtual void *allocate(size_t size, size_t alignment = alignof(std::max_align_t)) = 0;
+	virtual void deallocate(void *p, size_t size, size_t alignment = alignof(std::max_align_t)) = 0;
+};
+
+// Uses global new and delete.
+class NewDeleteResource : public MemoryResource
+{
+public:
+	void *allocate(size_t size, size_t) override	{ return ::operator new(size);	}
+	void deallocate(void *p, size_t, size_t) override	{ ::operator delete(p);	}
+};
+
+inline MemoryResource *newDeleteResource()
+{
+	static NewDeleteResource resource;
+	return &resource;
+}
+
+inline MemoryResource *&defaultResourcePointer()
+{
+	static MemoryResource *resource = newDeleteResource();
+	return resource;
+}
+// Resource used by default constructed containers and by all the copies.
+inline MemoryResource *defaultResource()	{ return defaultResourcePointer();	}
+// Sets the new default resource. Returns the previous one.
+// Containers already created keep using their resource.
+inline MemoryResource *setDefaultResource(MemoryResource *resource)
+{
+	MemoryResource *old = defaultResourcePointer();
+	defaultResourcePointer() = resource ? resource : newDeleteResource();
+	return old;
+}
+
+/*
+ * Allocator for the library containers. Takes memory from a MemoryResource,
+ * the default one if not specified.
+ *
+ * Copying a container gives a container using the default resource, so the
+ * copies don't depend on the lifetime of the original resource.
+ * Moving and swapping containers moves the resource too.
+ */
+template <typename T>
+class Allocator
+{
+	template <typename U> friend class Allocator;
+	MemoryResource *mResource;
+
+public:
+	typedef T value_type;
+	typedef std::false_type propagate_on_container_copy_assignment;
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+
+	Allocator() noexcept
+		: mResource(defaultResource())
+	{	}
+	Allocator(MemoryResource *resource) noexcept
+		: mResource(resource ? resource : defaultResource())
+	{	}
+	template <typename U>
+	Allocator(const Allocator<U> &other) noexcept
+		: mResource(other.mResource)
+	{	}
+
+	MemoryResource *resource() const	{ return mResource;	}
+
+	T *allocate(size_t n)
+	{
+		return static_cast<T*>( mResource->allocate(n * sizeof(T), alignof(T)) );
+	}
+	void deallocate(T *p, size_t n)
+	{
+		mResource->deallocate(p, n * sizeof(T), alignof(T));
+	}
+	Allocator select_on_container_copy_construction() const
+	{
+		return Allocator();
+	}
+
+	template <typename U>
+	bool operator==(const Allocator<U> &other) const	{ return mResource == other.mResource;	}
+	template <typename U>
+	bool operator!=(const Allocator<U> &other) const	{ return mResource != other.mResource;	}
+};
+
+} // namespace SNMP
+
+#endif // ALLOCATOR_H
@@ -0,0 +1,132 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+
+#include "basic_types.h"
+#include "allocator.h"
+
+namespace SNMP {
+
+/*
+ * Bump allocator. Memory is taken from big blocks and is never freed one by
+ * one: reset() makes all the blocks available again in O(1) and the blocks
+ * are reused by the next allocations. Blocks are freed on destruction.
+ *
+ * Not thread safe. Use one arena per thread (or per receive loop).
+ */
+class Arena : public MemoryResource
+{
+	struct Block
+	{
+		Block *next;
+		size_t size;
+		Byte *data()	{ return reinterpret_cast<Byte*>(this + 1);	}
+	};
+	static_assert( sizeof(Block) % alignof(std::max_align_t) == 0, "Block data must be well aligned" );
+
+	Block *mFirst;
+	Block *mCurrent;
+	Byte *mPos;
+	Byte *mEnd;
+	size_t mBlockSize;
+
+	Arena(const Arena &) = delete;
+	Arena &operator=(const Arena &) = delete;
+
+	void *allocateSlow(size_t size, size_t alignment)
+	{
+		// Reuses the next blocks left by reset() if big enough.
+		while( mCurrent && mCurrent->next )
+		{
+			mCurrent = mCurrent->next;
+			mPos = mCurrent->data();
+			mEnd = mPos + mCurrent->size;
+			if( void *p = allocateFast(size, alignment) )
+				return p;
+		}
+		size_t blockSize = (size + alignment > mBlockSize) ? size + alignment : mBlockSize;
+		Block *block = static_cast<Block*>( ::operator new(sizeof(Block) + blockSize) );
+		block->next = nullptr;
+		block->size = blockSize;
+		if( mCurrent )
+			mCurrent->next = block;
+		else
+			mFirst = block;
+		mCurrent = block;
+		mPos = block->data();
+		mEnd = mPos + blockSize;
+		return allocateFast(size, alignment);
+	}
+	void *allocateFast(size_t size, size_t alignment)
+	{
+		size_t misalign = reinterpret_cast<size_t>(mPos) & (alignment - 1);
+		Byte *p = misalign ? mPos + (alignment - misalign) : mPos;
+		if( (p > mEnd) || (static_cast<size_t>(mEnd - p) < size) )
+			return nullptr;
+		mPos = p + size;
+		return p;
+	}
+
+public:
+	explicit Arena(size_t blockSize = 16 * 1024)
+		: mFirst(nullptr)
+		, mCurrent(nullptr)
+		, mPos(nullptr)
+		, mEnd(nullptr)
+		, mBlockSize(blockSize)
+	{	}
+	~Arena() override
+	{
+		while( mFirst )
+		{
+			Block *next = mFirst->next;
+			::operator delete(mFirst);
+			mFirst = next;
+		}
+	}
+
+	void *allocate(size_t size, size_t alignment = alignof(std::max_align_t)) override
+	{
+		if( void *p = allocateFast(size, alignment) )
+			return p;
+		return allocateSlow(size, alignment);
+	}
+	// Memory is released by reset() only.
+	void deallocate(void *, size_t, size_t) override
+	{	}
+	// All the memory given by this arena becomes invalid.
+	void reset()
+	{
+		mCurrent = mFirst;
+		mPos = mFirst ? mFirst->data() : nullptr;
+		mEnd = mFirst ? mPos + mFirst->size : nullptr;
+	}
+};
+
+} // namespace SNMP
+
+#endif // ARENA_H
@@ -24,6 +24,11 @@
 
 using namespace SNMP;
 
+constexpr ASN1TypeSet ASN1Encoder::NumberTypes;
+constexpr ASN1TypeSet ASN1Encoder::RequestPDUTypes;
+constexpr ASN1TypeSet ASN1Encoder::MessagePDUTypes;
+constexpr ASN1TypeTable<ASN1ValueKind> ASN1Encoder::ValueKinds;
+
 bool ASN1Encoder::checkDataType(ErrorCode &errorCode, ASN1DataType actualType, ASN1DataType validType)
 {
 	if( actualType != validType )
@@ -34,9 +39,9 @@ bool ASN1Encoder::checkDataType(ErrorCode &errorCode, ASN1DataType actualType, A
 	return true;
 }
 
-bool ASN1Encoder::checkDataType(ErrorCode &errorCode, ASN1DataType actualType, const StdVector<ASN1DataType> &validTypes)
+bool ASN1Encoder::checkDataType(ErrorCode &errorCode, ASN1DataType actualType, const ASN1TypeSet &validTypes)
 {
-	if( validTypes.size() && !Utils::contains(validTypes, actualType) )
+	if( !validTypes[actualType] )
 	{
 		errorCode = ErrorCode::WrongType;
 		return false;
@@ -78,7 +83,7 @@ bool ASN1Encoder::checkDataRoom(ErrorCode &errorCode, const StdByteVector &ba, I
 bool ASN1Encoder::getTLVData(ErrorCode &errorCode,
 							const StdByteVector &ba,	// Byte Array received from SNMP agent.
 							Int64 &initialPos,			// Initial pos in the array to analize. Will point to data position if no error.
-							const std::vector<ASN1DataType> &validTypeList,	// Valid data type.
+							const ASN1TypeSet &validTypes,	// Valid data types.
 							ASN1DataType &actualType,	// Actual data received. Will be set if no error.
 							Int64 &length,				// The length of the data to retrieve. Will be set if no error.
 							Int64 minDataLength,		// The minimim data required. usually, it's 1.
@@ -90,7 +95,7 @@ bool ASN1Encoder::getTLVData(ErrorCode &errorCode,
 		return false;
 	}
 	actualType = ba[initialPos];
-	if( !checkDataType(errorCode, actualType, validTypeList) )
+	if( !checkDataType(errorCode, actualType, validTypes) )
 		return false;
 
 	initialPos++;
@@ -169,24 +174,34 @@ bool ASN1Encoder::getLength(ErrorCode &errorCode, const StdByteVector &ba, Int64
 	return false;
 }
 
-void ASN1Encoder::setLength(StdByteVector &ba, Int64 pos, Int64 length)
+int ASN1Encoder::encodeLength(Int64 length, Byte *bytes)
 {
 	// Length has two forms to be encoded.
 	// 1: If value is less than 127, it's encoded directly.
 	// 2: If value is greather, first byte encoded in the 7 less significant bits de quantity of bytes used to encode the actual length
 	if( length < 127 )
-		ba.insert( pos, static_cast<Byte>(length) );
-	else
 	{
-		int count = static_cast<int>( ((length - 1) >> 8) + 1 );
-		ba.insert( pos++, static_cast<Byte>(count | 0x80) );
+		bytes[0] = static_cast<Byte>(length);
+		return 1;
+	}
+	int count = 0;
+	for( Int64 l = length; l != 0; l >>= 8 )
+		++count;
 
-		while( length != 0 )
-		{
-			ba.insert( pos, static_cast<Byte>(length & 0xFF) );
-			length >>= 8;
-		}
+	bytes[0] = static_cast<Byte>(count | 0x80);
+	for( int i = count; i > 0; --i )
+	{
+		bytes[i] = static_cast<Byte>(length & 0xFF);
+		length >>= 8;
 	}
+	return count + 1;
+}
+
+void ASN1Encoder::setLength(StdByteVector &ba, Int64 pos, Int64 length)
+{
+	Byte bytes[9];
+	int count = encodeLength(length, bytes);
+	ba.insert( pos, StdByteVector(reinterpret_cast<const char*>(bytes), count) );
 }
 
 bool ASN1Encoder::decodeNULL(ErrorCode &/*errorCode*/, const StdByteVector &/*ba*/, Int64 &/*pos*/, Int64 /*length*/)
@@ -242,23 +257,30 @@ StdByteVector ASN1Encoder::encodeOctetString(const StdString &value)
 	StdByteVector ba;
 	ba.append( ASN1TYPE_OCTETSTRING );
 	setLength( ba, 1, static_cast<Int64>(value.size()) );
-	ba.append( value.data() );
+	ba.append( reinterpret_cast<const Byte*>(value.data()), static_cast<Int64>(value.size()) );
 	return ba;
 }
 
-void ASN1Encoder::encodeObjectIdentifierValue(const OIDValue &oidValue, StdByteVector &ba)
+int ASN1Encoder::encodeObjectIdentifierValue(UInt64 value, Byte *bytes)
 {
+	int used = 0;
 	int bitShift = 63;
 	UInt64 mask = 0x7F00000000000000u;
-	UInt64 value = oidValue.toULongLong();
 	while( mask )
 	{
 		if( value > mask )
-			ba.append( static_cast<char>((value >> bitShift) & 0x7Fu) | 0x80 );
+			bytes[used++] = static_cast<Byte>((value >> bitShift) & 0x7Fu) | 0x80;
 		mask >>= 7;
 		bitShift -= 7;
 	}
-	ba.append( static_cast<char>(value & 0x7Fu) );
+	bytes[used++] = static_cast<Byte>(value & 0x7Fu);
+	return used;
+}
+
+void ASN1Encoder::encodeObjectIdentifierValue(const OIDValue &oidValue, StdByteVector &ba)
+{
+	Byte bytes[10];
+	ba.append( bytes, encodeObjectIdentifierValue(oidValue.toULongLong(), bytes) );
 }
 bool ASN1Encoder::decodeObjectIdentifierValue(ErrorCode &errorCode, const StdByteVector &ba, Int64 &pos, OIDValue &oidValue)
 {
@@ -467,44 +489,39 @@ bool ASN1Encoder::decodeUnknown(ErrorCode &errorCode,
 								ASN1Variable &data )
 {
 	bool rtn;
-	switch( asn1Type )
+	switch( ValueKinds[asn1Type] )
 	{
-	case ASN1TYPE_NULL:
+	case ASN1ValueKind::Null:
 		rtn = decodeNULL(errorCode, ba, pos, length);
 		data.setNull();
 		break;
-	case ASN1TYPE_INTEGER:
-	case ASN1TYPE_Gauge32:
-	case ASN1TYPE_Counter:
-	case ASN1TYPE_Counter64:
-	case ASN1TYPE_Integer64:
-	case ASN1TYPE_Unsigned64:
+	case ASN1ValueKind::Number:
 		data.setType(asn1Type);
 		rtn = decodeInteger(errorCode, data, ba, pos, length);
 		data.setType(asn1Type);
 		break;
-	case ASN1TYPE_OBJECTID:
+	case ASN1ValueKind::ObjectID:
 		{
 			OID oid;
 			rtn = decodeObjectIdentifier(errorCode, oid, ba, pos, length);
 			data.setOID(oid);
 		}
 		break;
-	case ASN1TYPE_OCTETSTRING:
+	case ASN1ValueKind::OctetString:
 	  {
 		StdByteVector s;
 		rtn = decodeGenericString( errorCode, s, ba, pos, length );
 		data.setOctetString(s);
 	  }
 		break;
-	case ASN1TYPE_IPv4Address:
+	case ASN1ValueKind::IPv4Address:
 	  {
 		Utils::IPv4Address ipv4;
 		rtn = decodeIPv4Address( errorCode, ipv4, ba, pos, length );
 		data.setIPv4(ipv4);
 	  }
 		break;
-	case ASN1TYPE_Opaque:
+	case ASN1ValueKind::Data:
 	default:
 		{
 			rtn = true;
@@ -524,7 +541,7 @@ bool ASN1Encoder::decodeUnknown(ErrorCode &errorCode, const StdByteVector &ba, I
 		return false;
 
 	if( rawData != nullptr )
-		*rawData = ba.mid( pos, length );
+		rawData->assign( ba.begin() + pos, ba.begin() + pos + length );
 
 	return decodeUnknown(errorCode, ba, pos, length, asn1Type, asn1Var);
 }
@@ -601,15 +618,135 @@ bool ASN1Encoder::decodePDURequest(ErrorCode &errorCode, const StdByteVector &ba
 {
 	Int64 length;
 	ASN1DataType dataType;
-	static StdVector<ASN1DataType> validPDUTypes = {
-		ASN1TYPE_GetRequestPDU,
-		ASN1TYPE_SetRequestPDU,
-		ASN1TYPE_ResponcePDU
-	};
 
-	if( !getTLVData(errorCode, ba, pos, validPDUTypes, dataType, length, 0, 0x7FFFFFFF) )
+	if( !getTLVData(errorCode, ba, pos, RequestPDUTypes, dataType, length, 0, 0x7FFFFFFF) )
+		return false;
+
+	return true;
+}
+
+
+bool ASN1Encoder::getRawTLVData(ErrorCode &errorCode, const Byte *data, Int64 size, Int64 &pos, ASN1DataType &type, Int64 &length)
+{
+	if( pos >= size )
+	{
+		errorCode = ErrorCode::DatagramInterrupted;
+		return false;
+	}
+	type = data[pos++];
+	if( pos >= size )
+	{
+		errorCode = ErrorCode::DatagramInterrupted;
+		return false;
+	}
+	if( !(data[pos] & 0x80) ) // Less that 127.
+		length = data[pos++];
+	else
+	{
+		Int64 count = data[pos++] & 0x7F;
+		// More than 4 bytes for a length in a UDP datagram is nonsense.
+		if( (count == 0) || (count > 4) || ((size - pos) < count) )
+		{
+			errorCode = ErrorCode::DatagramInterrupted;
+			return false;
+		}
+		length = 0;
+		while( count-- > 0 )
+			length = (length << 8) | data[pos++];
+	}
+	if( (size - pos) < length )
+	{
+		errorCode = ErrorCode::NotEnoughRoom;
+		return false;
+	}
+	return true;
+}
+
+bool ASN1Encoder::decodeRawObjectIdentifier(ErrorCode &errorCode, OID &oid, const Byte *data, Int64 length)
+{
+	if( length < 1 )
+	{
+		errorCode = ErrorCode::WrongLength;
 		return false;
+	}
+	oid.clear( );
+	// At this point, we don't know the OID lenght, but we can make a guess.
+	oid.reserve( length + 1 );
+	oid.append( OIDValue(data[0] / 40) );
+	oid.append( OIDValue(data[0] % 40) );
 
+	UInt64 value = 0;
+	for( Int64 pos = 1; pos < length; ++pos )
+	{
+		value = (value << 7) | (data[pos] & 0x7F);
+		if( !(data[pos] & 0x80) )
+		{
+			oid.append( OIDValue(value) );
+			value = 0;
+		}
+	}
+	// Last byte cannot have the "more bytes" flag.
+	if( data[length-1] & 0x80 )
+	{
+		errorCode = ErrorCode::WrongEncoding;
+		return false;
+	}
 	return true;
 }
 
+// Must decode exactly the same as decodeUnknown
+bool ASN1Encoder::decodeRawUnknown(ErrorCode &errorCode, const Byte *data, Int64 length, ASN1DataType type, ASN1Variable &asn1Var, MemoryResource *resource)
+{
+	switch( ValueKinds[type] )
+	{
+	case ASN1ValueKind::Null:
+		asn1Var.setNull();
+		return true;
+	case ASN1ValueKind::Number:
+		if( (length > 0) && (data[0] & 0x80) )
+		{
+			Int64 i;
+			if( !decodeRawInteger(errorCode, i, data, length, false) )
+				return false;
+			asn1Var.setInteger(i);
+		}
+		else
+		{
+			UInt64 ui;
+			if( !decodeRawInteger(errorCode, ui, data, length, true) )
+				return false;
+			asn1Var.setUInteger(ui);
+		}
+		asn1Var.setType(type);
+		return true;
+	case ASN1ValueKind::ObjectID:
+		// Same checks as decodeRawObjectIdentifier, but without building an OID.
+		if( length < 1 )
+		{
+			errorCode = ErrorCode::WrongLength;
+			return false;
+		}
+		if( data[length-1] & 0x80 )
+		{
+			errorCode = ErrorCode::WrongEncoding;
+			return false;
+		}
+		asn1Var.setOIDFromBER(data, length, resource);
+		return true;
+	case ASN1ValueKind::OctetString:
+		asn1Var.setOctetString(data, length, resource);
+		return true;
+	case ASN1ValueKind::IPv4Address:
+		if( length != 4 )
+		{
+			errorCode = ErrorCode::WrongLength;
+			return false;
+		}
+		asn1Var.setIPv4( data[0], data[1], data[2], data[3] );
+		return true;
+	case ASN1ValueKind::Data:
+	default:
+		asn1Var.setData(type, data, length, resource);
+		return true;
+	}
+}
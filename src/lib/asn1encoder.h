@@ -28,6 +28,7 @@
 #include "stdstring.h"
 
 #include "asn1types.h"
+#include "asn1typetable.h"
 #include "asn1variable.h"
 
 
@@ -65,12 +66,18 @@ public:
 	} mErrorCode;
 	static StdString printableErrorCode(ErrorCode errorCode);
 
+	// Type tables for every decoding context. See ASN1TypeTable.
+	static constexpr ASN1TypeSet NumberTypes = ASN1TypeSet( ASN1TypePolicies::Numbers() );
+	static constexpr ASN1TypeSet RequestPDUTypes = ASN1TypeSet( ASN1TypePolicies::RequestPDUs() );
+	static constexpr ASN1TypeSet MessagePDUTypes = ASN1TypeSet( ASN1TypePolicies::MessagePDUs() );
+	static constexpr ASN1TypeTable<ASN1ValueKind> ValueKinds = ASN1TypeTable<ASN1ValueKind>( ASN1TypePolicies::ValueKinds() );
+
 private:
 	static bool checkDataType(ErrorCode &errorCode, ASN1DataType actualType, ASN1DataType validType);
-	static bool checkDataType(ErrorCode &errorCode, ASN1DataType actualType, const StdVector<ASN1DataType> &validTypes);
+	static bool checkDataType(ErrorCode &errorCode, ASN1DataType actualType, const ASN1TypeSet &validTypes);
 	static bool checkDataLength(ErrorCode &errorCode, const StdByteVector &ba, Int64 dataPos, Int64 actualLength, Int64 minLength, Int64 maxLength = 0xFFFFFFFF);
 	static bool checkDataRoom(ErrorCode &errorCode, const StdByteVector &ba, Int64 initialDataPos, Int64 dataLength);
-	static bool getTLVData(ErrorCode &errorCode, const StdByteVector &ba, Int64 &initialPos, const std::vector<ASN1DataType> &validTypeList, ASN1DataType &actualType, Int64 &length, Int64 minDataLength, Int64 maxDataLength);
+	static bool getTLVData(ErrorCode &errorCode, const StdByteVector &ba, Int64 &initialPos, const ASN1TypeSet &validTypes, ASN1DataType &actualType, Int64 &length, Int64 minDataLength, Int64 maxDataLength);
 	static bool getTLVData(ErrorCode &errorCode, const StdByteVector &ba, Int64 &initialPos, ASN1DataType validType, Int64 &length, Int64 minDataLength, Int64 maxDataLength = 0x7FFFFFFF);
 	static bool getTLVData(ErrorCode &errorCode, const StdByteVector &ba, Int64 &initialPos, ASN1DataType &validType, Int64 &length);
 
@@ -113,17 +120,20 @@ private:
 	static void setLength(StdByteVector &ba, Int64 pos, Int64 length);
 
 public:
+	// Encodes the length field into bytes. bytes must have room for 9 bytes.
+	// Returns the number of bytes used.
+	static int encodeLength(Int64 length, Byte *bytes);
+
+	// Encodes just the value of an integer (no type nor length) into bytes.
+	// bytes must have room for sizeof(T)+1 bytes. Returns the number of bytes used.
 	template<typename T>
-	static inline StdByteVector encodeInteger(T value, ASN1DataType type, bool isUnsigned)
+	static inline int encodeIntegerValue(T value, bool isUnsigned, Byte *bytes)
 	{
-		StdByteVector ba;
-		ba.append( type );
 		// For this small values, below 127, no need to go through such complicated code.
 		if( !(value & ~static_cast<T>(0x7F))  )
 		{
-			ba.append( static_cast<char>(0x01) );
-			ba.append( static_cast<char>(value) );
-			return ba;
+			bytes[0] = static_cast<Byte>(value);
+			return 1;
 		}
 
 		if( isUnsigned && !(value & static_cast<T>(0x1) << ((8 * sizeof(T)) - 1)) )
@@ -143,34 +153,37 @@ public:
 			integerSize--;
 			value <<= 8;	// Eliminates the 8 most significant bits.
 		}
-		setLength( ba, 1, integerSize + (isUnsigned ? 1 : 0) );
+		int used = 0;
 		if( isUnsigned )
-			ba.append( static_cast<char>(0x00) );
+			bytes[used++] = 0x00;
 		// Mask 8 first bits: 0xFF00......
 		mask = static_cast<UInt64>(0xFF) << (8 * (sizeof(T) -1));
 		while( integerSize-- )
 		{
-			ba.append( static_cast<char>((static_cast<UInt64>(value) & mask) >> (8*(sizeof(T)-1))) );
+			bytes[used++] = static_cast<Byte>((static_cast<UInt64>(value) & mask) >> (8*(sizeof(T)-1)));
 			value <<= 8;
 		}
+		return used;
+	}
+	template<typename T>
+	static inline StdByteVector encodeInteger(T value, ASN1DataType type, bool isUnsigned)
+	{
+		Byte bytes[sizeof(T)+1];
+		int length = encodeIntegerValue(value, isUnsigned, bytes);
 
+		StdByteVector ba;
+		ba.reserve( length + 2 );
+		ba.append( type );
+		ba.append( static_cast<Byte>(length) );
+		ba.append( bytes, length );
 		return ba;
 	}
 	static inline bool decodeInteger(ErrorCode &errorCode, ASN1Variable &asnVar, const StdByteVector &ba, Int64 &pos)
 	{
 		Int64 length;
 
-		static std::vector<ASN1DataType> validNumberTypes = {
-			ASN1TYPE_INTEGER,
-			ASN1TYPE_Counter,
-			ASN1TYPE_Counter64,
-			ASN1TYPE_Integer64,
-			ASN1TYPE_Gauge32,
-			ASN1TYPE_TimeTicks,
-			ASN1TYPE_Unsigned64
-		};
 		ASN1DataType asn1Type;
-		if( !getTLVData(errorCode, ba, pos, validNumberTypes, asn1Type, length, 1, asnVar.maxNumberSize()+1) )
+		if( !getTLVData(errorCode, ba, pos, NumberTypes, asn1Type, length, 1, asnVar.maxNumberSize()+1) )
 			return false;
 		asnVar.setType(asn1Type);
 		return decodeInteger(errorCode, asnVar, ba, pos, length);
@@ -179,17 +192,8 @@ public:
 	static inline bool decodeInteger(ErrorCode &errorCode, T &number, const StdByteVector &ba, Int64 &pos, bool isUnsigned)
 	{
 		Int64 length;
-		static std::vector<ASN1DataType> validNumberTypes = {
-			ASN1TYPE_INTEGER,
-			ASN1TYPE_Counter,
-			ASN1TYPE_Counter64,
-			ASN1TYPE_Integer64,
-			ASN1TYPE_Gauge32,
-			ASN1TYPE_TimeTicks,
-			ASN1TYPE_Unsigned64
-		};
 		ASN1DataType asn1Type;
-		if( !getTLVData(errorCode, ba, pos, validNumberTypes, asn1Type, length, 1, ASN1Variable::maxNumberSize() + (isUnsigned ? 1 : 0)) )
+		if( !getTLVData(errorCode, ba, pos, NumberTypes, asn1Type, length, 1, ASN1Variable::maxNumberSize() + (isUnsigned ? 1 : 0)) )
 			return false;
 		return decodeInteger(errorCode, number, ba, pos, length, isUnsigned);
 	}
@@ -201,6 +205,9 @@ public:
 
 	static bool decodeObjectIdentifierValue(ErrorCode &errorCode, const StdByteVector &ba, Int64 &pos, OIDValue &oidValue);
 	static void encodeObjectIdentifierValue(const OIDValue &oidValue, StdByteVector &ba);
+	// Encodes one OID arc into bytes. bytes must have room for 10 bytes.
+	// Returns the number of bytes used.
+	static int encodeObjectIdentifierValue(UInt64 value, Byte *bytes);
 
 	static bool decodeObjectIdentifier(ErrorCode &errorCode, OID &oid, const StdByteVector &ba, Int64 &pos);
 	static bool decodeObjectIdentifier(ErrorCode &errorCode, ASN1Variable &asn1Var, const StdByteVector &ba, Int64 &pos);
@@ -226,6 +233,39 @@ public:
 	static StdByteVector encodeSequence(const StdByteVectorList &baList);
 
 	static bool decodePDURequest(ErrorCode &errorCode, const StdByteVector &ba, Int64 &pos);
+
+	// Raw functions. They work directly over the received bytes without copying them.
+	// Used by zero-copy decoders as MessageView.
+	// data points to the value (after type and length) and there are, at least, length bytes.
+	static bool getRawTLVData(ErrorCode &errorCode, const Byte *data, Int64 size, Int64 &pos, ASN1DataType &type, Int64 &length);
+
+	template<typename T>
+	static inline bool decodeRawInteger(ErrorCode &errorCode, T &value, const Byte *data, Int64 length, bool isUnsigned)
+	{
+		if( (length < 1) || (length > static_cast<Int64>(sizeof(T) + 1)) )
+		{
+			errorCode = ErrorCode::WrongLength;
+			return false;
+		}
+		UInt64 v = 0;
+		if( data[0] & 0x80 )
+		{
+			if( isUnsigned )
+			{
+				errorCode = ErrorCode::UnsignedMalformed;
+				value = 0;
+				return false;
+			}
+			v = ~static_cast<UInt64>(0);
+		}
+		for( Int64 i = 0; i < length; ++i )
+			v = (v << 8) | data[i];
+		value = static_cast<T>(v);
+		return true;
+	}
+	static bool decodeRawObjectIdentifier(ErrorCode &errorCode, OID &oid, const Byte *data, Int64 length);
+	// Long values are taken from resource (the default one if null). See ASN1Variable.
+	static bool decodeRawUnknown(ErrorCode &errorCode, const Byte *data, Int64 length, ASN1DataType type, ASN1Variable &asn1Var, MemoryResource *resource = nullptr);
 };
 
 }	// namespace ASN1
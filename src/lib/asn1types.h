@@ -82,6 +82,10 @@ typedef Byte ASN1DataType;
 #define ASN1TYPE_ResponcePDU			(ASN1TYPECLASS_CONTEXT_SPECIFIC | ASN1TYPEBASE_CONSTRUCTED | static_cast<SNMP::ASN1DataType>(0x02))	// 0xA2
 #define ASN1TYPE_SetRequestPDU			(ASN1TYPECLASS_CONTEXT_SPECIFIC | ASN1TYPEBASE_CONSTRUCTED | static_cast<SNMP::ASN1DataType>(0x03))	// 0xA3
 #define ASN1TYPE_TrapPDU				(ASN1TYPECLASS_CONTEXT_SPECIFIC | ASN1TYPEBASE_CONSTRUCTED | static_cast<SNMP::ASN1DataType>(0x04))	// 0xA4
+#define ASN1TYPE_GetBulkRequestPDU		(ASN1TYPECLASS_CONTEXT_SPECIFIC | ASN1TYPEBASE_CONSTRUCTED | static_cast<SNMP::ASN1DataType>(0x05))	// 0xA5
+#define ASN1TYPE_InformRequestPDU		(ASN1TYPECLASS_CONTEXT_SPECIFIC | ASN1TYPEBASE_CONSTRUCTED | static_cast<SNMP::ASN1DataType>(0x06))	// 0xA6
+#define ASN1TYPE_TrapV2PDU				(ASN1TYPECLASS_CONTEXT_SPECIFIC | ASN1TYPEBASE_CONSTRUCTED | static_cast<SNMP::ASN1DataType>(0x07))	// 0xA7
+#define ASN1TYPE_ReportPDU				(ASN1TYPECLASS_CONTEXT_SPECIFIC | ASN1TYPEBASE_CONSTRUCTED | static_cast<SNMP::ASN1DataType>(0x08))	// 0xA8
 
 
 #endif // ASN1TYPES_H
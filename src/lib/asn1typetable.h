@@ -0,0 +1,134 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef ASN1TYPETABLE_H
+#define ASN1TYPETABLE_H
+
+#include "basic_types.h"
+#include "asn1types.h"
+
+namespace SNMP {
+
+// Compile time list of indexes 0..N-1, like C++14 std::make_index_sequence.
+template <int... I>
+struct IndexList
+{	};
+template <int N, int... I>
+struct MakeIndexList : MakeIndexList<N-1, N-1, I...>
+{	};
+template <int... I>
+struct MakeIndexList<0, I...>
+{
+	typedef IndexList<I...> type;
+};
+
+/*
+ * 256 entries table indexed by ASN1 type, built at compile time.
+ * So, looking up a type is just one indexed load.
+ *
+ * Entries are given by a Policy class with a constexpr static function:
+ * T entry(int type)
+ */
+template <typename T>
+class ASN1TypeTable
+{
+	T mEntries[256];
+
+	template <typename Policy, int... I>
+	constexpr ASN1TypeTable(Policy, IndexList<I...>)
+		: mEntries{ Policy::entry(I)... }
+	{	}
+
+public:
+	template <typename Policy>
+	constexpr explicit ASN1TypeTable(Policy policy)
+		: ASN1TypeTable(policy, typename MakeIndexList<256>::type())
+	{	}
+	constexpr T operator[](ASN1DataType type) const	{ return mEntries[type];	}
+};
+// Valid types for a context.
+typedef ASN1TypeTable<bool> ASN1TypeSet;
+
+// How every type is decoded into an ASN1Variable.
+enum class ASN1ValueKind : Byte
+{
+	Data,		// Unknown types are stored as bytes.
+	Null,
+	Number,
+	ObjectID,
+	OctetString,
+	IPv4Address
+};
+
+namespace ASN1TypePolicies {
+
+// Numeric values.
+struct Numbers
+{
+	static constexpr bool entry(int type)
+	{
+		return (type == ASN1TYPE_INTEGER) ||
+			   (type == ASN1TYPE_Counter) ||
+			   (type == ASN1TYPE_Counter64) ||
+			   (type == ASN1TYPE_Integer64) ||
+			   (type == ASN1TYPE_Gauge32) ||
+			   (type == ASN1TYPE_TimeTicks) ||
+			   (type == ASN1TYPE_Unsigned64);
+	}
+};
+// PDUs accepted by the ASN1Encoder stream decoder.
+struct RequestPDUs
+{
+	static constexpr bool entry(int type)
+	{
+		return (type == ASN1TYPE_GetRequestPDU) ||
+			   (type == ASN1TYPE_SetRequestPDU) ||
+			   (type == ASN1TYPE_ResponcePDU);
+	}
+};
+// PDUs sharing the request structure. Trap PDU (SNMPv1) has another one.
+struct MessagePDUs
+{
+	static constexpr bool entry(int type)
+	{
+		return (type >= ASN1TYPE_GetRequestPDU) && (type <= ASN1TYPE_ReportPDU) && (type != ASN1TYPE_TrapPDU);
+	}
+};
+// Varbind values.
+struct ValueKinds
+{
+	static constexpr ASN1ValueKind entry(int type)
+	{
+		return (type == ASN1TYPE_NULL) ? ASN1ValueKind::Null :
+			   Numbers::entry(type) ? ASN1ValueKind::Number :
+			   (type == ASN1TYPE_OBJECTID) ? ASN1ValueKind::ObjectID :
+			   (type == ASN1TYPE_OCTETSTRING) ? ASN1ValueKind::OctetString :
+			   (type == ASN1TYPE_IPv4Address) ? ASN1ValueKind::IPv4Address :
+			   ASN1ValueKind::Data;
+	}
+};
+
+} // namespace ASN1TypePolicies
+
+} // namespace SNMP
+
+#endif // ASN1TYPETABLE_H
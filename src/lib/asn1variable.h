@@ -23,7 +23,11 @@
 #ifndef ASN1VARIABLE_H
 #define ASN1VARIABLE_H
 
+#include <cstring>
+
+#include "allocator.h"
 #include "stdcharvector.h"
+#include "byteview.h"
 
 #include "asn1types.h"
 #include "../utils.h"
@@ -31,105 +35,365 @@
 
 namespace SNMP {
 
+/*
+ * Holds one ASN1 value.
+ *
+ * Only the active value is stored, so the object is just 24 bytes:
+ * numbers and IPv4 addresses are stored as a 64 bits number and octet
+ * strings and OIDs as bytes. Up to InlineSize bytes are stored inside the
+ * object itself, so short strings and OIDs don't allocate any memory.
+ *
+ * OIDs are stored as the arcs in base 128 (like in BER, but with the first
+ * two arcs in its own byte each), so most OIDs fits inline too.
+ *
+ * Longer values are taken from a MemoryResource: the one given to the
+ * setters or the default one. With an Arena, the bytes are valid until the
+ * arena is reset. Copies of such variables use the default resource.
+ */
 class ASN1Variable
 {
-	ASN1DataType mDataType;
+public:
+	static const Int64 InlineSize = 22;
 
-	struct Value
+private:
+	enum Storage : Byte
+	{
+		// Values from 0 to InlineSize are the count of inline bytes.
+		NumberStorage = 0xFE,
+		HeapStorage = 0xFF
+	};
+	ASN1DataType mDataType;
+	Byte mStorage;
+	// Number and heap fields are copied with memcpy because they are not aligned.
+	// Number and heap pointer are placed at offset 8 of the object.
+	Byte mData[InlineSize];
+	enum : size_t
+	{
+		NumberOffset = 6,
+		HeapCapacityOffset = 0,
+		HeapSizeOffset = 2,
+		HeapPointerOffset = 6,
+		HeapResourceOffset = 14
+	};
+
+	UInt64 number() const
+	{
+		UInt64 n = 0;
+		if( mStorage == NumberStorage )
+			memcpy( &n, mData + NumberOffset, sizeof(n) );
+		return n;
+	}
+	void setNumber(ASN1DataType type, UInt64 n)
+	{
+		release();
+		mDataType = type;
+		mStorage = NumberStorage;
+		memcpy( mData + NumberOffset, &n, sizeof(n) );
+	}
+	Byte *heapBytes() const
+	{
+		Byte *bytes;
+		memcpy( &bytes, mData + HeapPointerOffset, sizeof(bytes) );
+		return bytes;
+	}
+	// SNMP values are far below 4GB, so 32 bits are enough.
+	Int64 heapSize() const
+	{
+		UInt32 size;
+		memcpy( &size, mData + HeapSizeOffset, sizeof(size) );
+		return size;
+	}
+	// Capacity is stored only if it fits in 16 bits, as any value received
+	// in a datagram does. Otherwise, it's 0 and the buffer is not reused.
+	Int64 heapCapacity() const
+	{
+		UInt16 capacity;
+		memcpy( &capacity, mData + HeapCapacityOffset, sizeof(capacity) );
+		return capacity;
+	}
+	size_t heapAllocatedSize() const
+	{
+		Int64 capacity = heapCapacity();
+		return static_cast<size_t>(capacity ? capacity : heapSize());
+	}
+	MemoryResource *heapResource() const
+	{
+		MemoryResource *resource;
+		memcpy( &resource, mData + HeapResourceOffset, sizeof(resource) );
+		return resource;
+	}
+	void release()
 	{
-		union Number
+		if( mStorage == HeapStorage )
+			heapResource()->deallocate( heapBytes(), heapAllocatedSize(), 1 );
+		mStorage = NumberStorage;
+	}
+	// Prepares room for size bytes and returns where to write them.
+	// A buffer from the same resource is reused if big enough, so overwriting
+	// values doesn't allocate once the variable has seen the bigger one.
+	Byte *allocateBytes(ASN1DataType type, Int64 size, MemoryResource *resource = nullptr)
+	{
+		UInt32 size32 = static_cast<UInt32>(size);
+		if( size <= InlineSize )
 		{
-			bool boolean;
-			int Integer32;
-			UInt32 UInteger32;
-			Int64 Integer64;
-			UInt64 UInteger64;
-			float Float;
-			double Double;
-			Number()
-				: UInteger64(0)
-			{	}
-		}number;
-		Utils::IPv4Address ipv4Address;
-
-		bool isNegative;
-		OID oid;
-		StdByteVector octetString;
-		Value()
-			: isNegative(false)
+			release();
+			mDataType = type;
+			mStorage = static_cast<Byte>(size);
+			return mData;
+		}
+		if( !resource )
+			resource = defaultResource();
+		mDataType = type;
+		if( (mStorage == HeapStorage) && (heapResource() == resource) && (size <= heapCapacity()) )
 		{
+			memcpy( mData + HeapSizeOffset, &size32, sizeof(size32) );
+			return heapBytes();
 		}
-	} mDataValue;
+		release();
+		Byte *bytes = static_cast<Byte*>(resource->allocate(static_cast<size_t>(size), 1));
+		UInt16 capacity = (size <= 0xFFFF) ? static_cast<UInt16>(size) : 0;
+		memcpy( mData + HeapCapacityOffset, &capacity, sizeof(capacity) );
+		memcpy( mData + HeapSizeOffset, &size32, sizeof(size32) );
+		memcpy( mData + HeapPointerOffset, &bytes, sizeof(bytes) );
+		memcpy( mData + HeapResourceOffset, &resource, sizeof(resource) );
+		mStorage = HeapStorage;
+		return bytes;
+	}
+	void copyBytes(ASN1DataType type, const Byte *bytes, Int64 size, MemoryResource *resource = nullptr)
+	{
+		Byte *dst = allocateBytes(type, size, resource);
+		if( size > 0 )
+			memcpy( dst, bytes, static_cast<size_t>(size) );
+	}
+	bool isBytesStorage() const	{ return mStorage != NumberStorage;	}
+	const Byte *bytesData() const
+	{
+		return (mStorage == HeapStorage) ? heapBytes() : mData;
+	}
+	Int64 bytesSize() const
+	{
+		switch( mStorage )
+		{
+		case NumberStorage:	return 0;
+		case HeapStorage:	return heapSize();
+		}
+		return mStorage;
+	}
+	void copyFrom(const ASN1Variable &other, MemoryResource *resource = nullptr)
+	{
+		if( other.mStorage == HeapStorage )
+			copyBytes( other.mDataType, other.heapBytes(), other.heapSize(), resource );
+		else
+		{
+			release();
+			mDataType = other.mDataType;
+			mStorage = other.mStorage;
+			memcpy( mData, other.mData, sizeof(mData) );
+		}
+	}
+	void moveFrom(ASN1Variable &other)
+	{
+		release();
+		mDataType = other.mDataType;
+		mStorage = other.mStorage;
+		memcpy( mData, other.mData, sizeof(mData) );
+		// The heap bytes now belong to this object.
+		other.mStorage = NumberStorage;
+	}
+
+	static int arcSize(UInt64 arc)
+	{
+		int size = 1;
+		while( arc >>= 7 )
+			++size;
+		return size;
+	}
 
 public:
 	ASN1Variable()
 		: mDataType(ASN1TYPE_NULL)
+		, mStorage(NumberStorage)
+	{
+		memset( mData, 0, sizeof(mData) );
+	}
+	ASN1Variable(const ASN1Variable &other)
+		: ASN1Variable()
 	{
+		copyFrom(other);
 	}
+	ASN1Variable(ASN1Variable &&other)
+		: ASN1Variable()
+	{
+		moveFrom(other);
+	}
+	~ASN1Variable()
+	{
+		release();
+	}
+	ASN1Variable &operator=(const ASN1Variable &other)
+	{
+		if( this != &other )
+			copyFrom(other);
+		return *this;
+	}
+	ASN1Variable &operator=(ASN1Variable &&other)
+	{
+		if( this != &other )
+			moveFrom(other);
+		return *this;
+	}
+	// Copies other taking the long values from resource.
+	void assign(const ASN1Variable &other, MemoryResource *resource)
+	{
+		if( this != &other )
+			copyFrom(other, resource);
+	}
+	// Resource holding the value or nullptr if it's stored inline.
+	MemoryResource *resource() const	{ return (mStorage == HeapStorage) ? heapResource() : nullptr;	}
+
+	// Same type and value, wherever it's stored.
+	bool operator==(const ASN1Variable &other) const
+	{
+		if( (mDataType != other.mDataType) || ((mStorage == NumberStorage) != (other.mStorage == NumberStorage)) )
+			return false;
+		if( mStorage == NumberStorage )
+			return number() == other.number();
+		return ByteView( bytesData(), bytesSize() ) == ByteView( other.bytesData(), other.bytesSize() );
+	}
+	bool operator!=(const ASN1Variable &other) const	{ return !operator==(other);	}
+
+	// Raw storage, to keep values out of the variable (see snapshot.h).
+	// Numbers are read by toUInteger() and set back by setUInteger() and
+	// setType(); bytes, whatever the type is, are set back by setData().
+	bool isNumberStorage() const	{ return mStorage == NumberStorage;	}
+	ByteView storedBytes() const	{ return ByteView( bytesData(), bytesSize() );	}
+
 	static int maxNumberSize()			{ return sizeof(double);}
 	ASN1DataType type() const			{ return mDataType;		}
 	void setType(ASN1DataType asn1Type)	{ mDataType = asn1Type;	}
 
-	void setNull()						{ mDataType = ASN1TYPE_NULL;	}
+	void setNull()						{ setNumber(ASN1TYPE_NULL, 0);	}
 
-	bool toBoolean()const				{ return mDataValue.number.boolean;	}
-	void setBoolean(bool b)				{ mDataType = ASN1TYPE_BOOLEAN;	mDataValue.number.boolean = b;	}
+	bool toBoolean()const				{ return number() != 0;	}
+	void setBoolean(bool b)				{ setNumber(ASN1TYPE_BOOLEAN, b ? 1 : 0);	}
 
-	Int64 toInteger() const				{ return mDataValue.number.Integer64;	}
-	int toInteger32() const				{ return static_cast<int>(mDataValue.number.UInteger64);	}
-	void setInteger(Int64 i)			{ mDataType = ASN1TYPE_INTEGER;	mDataValue.number.Integer64 = i;	}
+	Int64 toInteger() const				{ return static_cast<Int64>(number());	}
+	int toInteger32() const				{ return static_cast<int>(number());	}
+	void setInteger(Int64 i)			{ setNumber(ASN1TYPE_INTEGER, static_cast<UInt64>(i));	}
 
-	UInt64 toUInteger() const			{ return mDataValue.number.UInteger64;	}
-	UInt32 toUInteger32() const			{ return static_cast<UInt32>(mDataValue.number.UInteger64);	}
-	void setUInteger(UInt64 i)			{ mDataType = ASN1TYPE_INTEGER;	mDataValue.number.UInteger64 = i;}
+	UInt64 toUInteger() const			{ return number();	}
+	UInt32 toUInteger32() const			{ return static_cast<UInt32>(number());	}
+	void setUInteger(UInt64 i)			{ setNumber(ASN1TYPE_INTEGER, i);	}
 
-	Int64 toInteger64() const			{ return mDataValue.number.Integer64;	}
-	void setInteger64(Int64 i)			{ mDataType = ASN1TYPE_Integer64;	mDataValue.number.Integer64 = i;	}
+	Int64 toInteger64() const			{ return static_cast<Int64>(number());	}
+	void setInteger64(Int64 i)			{ setNumber(ASN1TYPE_Integer64, static_cast<UInt64>(i));	}
 
-	UInt64 toUnsigned64() const			{ return mDataValue.number.UInteger64;	}
-	void setUnsigned64(UInt64 i)		{ mDataType = ASN1TYPE_Unsigned64;	mDataValue.number.UInteger64 = i;	}
+	UInt64 toUnsigned64() const			{ return number();	}
+	void setUnsigned64(UInt64 i)		{ setNumber(ASN1TYPE_Unsigned64, i);	}
 
 	UInt32 toGauge32() const	{ return toUInteger32();	}
-	void setGauge32(UInt32 i)	{ mDataType = ASN1TYPE_Gauge32;	mDataValue.number.UInteger32 = i;	}
+	void setGauge32(UInt32 i)	{ setNumber(ASN1TYPE_Gauge32, i);	}
 
 	UInt64 toGauge64() const	{ return toUnsigned64();	}
-	void setGauge64(UInt64 i)	{ mDataType = ASN1TYPE_Unsigned64;	mDataValue.number.UInteger64 = i;	}
+	void setGauge64(UInt64 i)	{ setNumber(ASN1TYPE_Unsigned64, i);	}
 
 	UInt64 toCounter() const	{ return toUnsigned64();	}
-	void setCounter(UInt64 i)	{ mDataType = ASN1TYPE_Counter;	mDataValue.number.UInteger64 = i;	}
+	void setCounter(UInt64 i)	{ setNumber(ASN1TYPE_Counter, i);	}
 
 	UInt64 toCounter64() const	{ return toUnsigned64();	}
-	void setCounter64(UInt64 i)	{ mDataType = ASN1TYPE_Counter64;	mDataValue.number.UInteger64 = i;	}
+	void setCounter64(UInt64 i)	{ setNumber(ASN1TYPE_Counter64, i);	}
 
 	UInt64 toTimeTicks() const	{ return toUnsigned64();	}
-	void setTimeTicks(UInt64 i)	{ mDataType = ASN1TYPE_TimeTicks;	mDataValue.number.UInteger64 = i;	}
+	void setTimeTicks(UInt64 i)	{ setNumber(ASN1TYPE_TimeTicks, i);	}
 
-	const OID &toOID() const		{ return mDataValue.oid;	}
-	void setOID(const OID &oid)		{ mDataType = ASN1TYPE_OBJECTID;	mDataValue.oid = oid;	}
+	// OID is decoded from the stored bytes on every call.
+	OID toOID() const
+	{
+		OID oid;
+		if( (mDataType != ASN1TYPE_OBJECTID) || !isBytesStorage() )
+			return oid;
+		const Byte *bytes = bytesData();
+		Int64 size = bytesSize();
+		oid.reserve(size);
+		UInt64 value = 0;
+		for( Int64 i = 0; i < size; ++i )
+		{
+			value = (value << 7) | (bytes[i] & 0x7F);
+			if( !(bytes[i] & 0x80) )
+			{
+				oid.append( OIDValue(value) );
+				value = 0;
+			}
+		}
+		return oid;
+	}
+	void setOID(const OID &oid)
+	{
+		Int64 size = 0;
+		for( OIDValue arc : oid )
+			size += arcSize( arc.toULongLong() );
+		Byte *bytes = allocateBytes(ASN1TYPE_OBJECTID, size);
+		for( OIDValue arc : oid )
+		{
+			UInt64 value = arc.toULongLong();
+			int s = arcSize(value);
+			while( --s >= 0 )
+				*bytes++ = static_cast<Byte>( ((value >> (7 * s)) & 0x7F) | (s ? 0x80 : 0x00) );
+		}
+	}
+	// Sets the OID from its BER encoded bytes, without type nor length.
+	// Those bytes must be checked before as this function doesn't validate them.
+	void setOIDFromBER(const Byte *ber, Int64 length, MemoryResource *resource = nullptr)
+	{
+		if( length < 1 )
+		{
+			allocateBytes(ASN1TYPE_OBJECTID, 0);
+			return;
+		}
+		// Only the first byte changes: it holds the two first arcs.
+		Byte *bytes = allocateBytes(ASN1TYPE_OBJECTID, length + 1, resource);
+		bytes[0] = ber[0] / 40;
+		bytes[1] = ber[0] % 40;
+		if( length > 1 )
+			memcpy( bytes + 2, ber + 1, static_cast<size_t>(length - 1) );
+	}
 
 	// Don't use it to print text as OctetString may not contains the \0 ending. Use toStdString instead.
-	const StdByteVector &toOctetString() const		{ return mDataValue.octetString;	}
-	void setOctetString(const StdByteVector &str)	{ mDataType = ASN1TYPE_OCTETSTRING;	mDataValue.octetString = str;	}
+	// Returns a copy. Use octetStringView() to look at the bytes without copying them.
+	StdByteVector toOctetString() const
+	{
+		ByteView view = octetStringView();
+		return StdByteVector( view.chars(), view.count() );
+	}
+	ByteView octetStringView() const
+	{
+		if( mDataType == ASN1TYPE_OBJECTID )
+			return ByteView();
+		return ByteView( bytesData(), bytesSize() );
+	}
+	void setOctetString(const StdByteVector &str)	{ copyBytes(ASN1TYPE_OCTETSTRING, str.bytes(), str.count());	}
+	void setOctetString(const StdString &str)		{ copyBytes(ASN1TYPE_OCTETSTRING, reinterpret_cast<const Byte*>(str.data()), static_cast<Int64>(str.size()));	}
+	void setOctetString(const Byte *bytes, Int64 size, MemoryResource *resource = nullptr)	{ copyBytes(ASN1TYPE_OCTETSTRING, bytes, size, resource);	}
 
-	StdString toStdString() const					{ return mDataValue.octetString.toStdString(); }
+	StdString toStdString() const					{ return octetStringView().toStdString(); }
 
-	void setData(ASN1DataType type, const StdByteVector &ba)	{ mDataType = type; mDataValue.octetString = ba;	}
+	void setData(ASN1DataType type, const StdByteVector &ba)	{ copyBytes(type, ba.bytes(), ba.count());	}
+	void setData(ASN1DataType type, const Byte *bytes, Int64 size, MemoryResource *resource = nullptr)	{ copyBytes(type, bytes, size, resource);	}
 
-	const Utils::IPv4Address &toIPV4() const			{ return mDataValue.ipv4Address;	}
-	void setIPv4(const Utils::IPv4Address &ipv4)		{ mDataValue.ipv4Address = ipv4;	}
+	Utils::IPv4Address toIPV4() const					{ return Utils::IPv4Address( static_cast<UInt32>(number()) );	}
+	void setIPv4(const Utils::IPv4Address &ipv4)		{ setNumber(ASN1TYPE_IPv4Address, ipv4.number());	}
 	void setIPv4(unsigned char octetA, unsigned char octetB, unsigned char octetC, unsigned char octetD)
 	{
-		mDataValue.ipv4Address.setOctetA( octetA );
-		mDataValue.ipv4Address.setOctetB( octetB );
-		mDataValue.ipv4Address.setOctetC( octetC );
-		mDataValue.ipv4Address.setOctetD( octetD );
+		setIPv4( Utils::IPv4Address(octetA, octetB, octetC, octetD) );
 	}
 
 	void clear()
 	{
-		mDataType = ASN1TYPE_NULL;
+		setNull();
 	}
 };
+static_assert( sizeof(ASN1Variable) == 24, "ASN1Variable must be 24 bytes long" );
+
 } // namespace ASN1
 
 #endif // ASN1VARIABLE_H
@@ -0,0 +1,95 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#include "asn1writer.h"
+
+using namespace SNMP;
+
+void ASN1Writer::writeHeader(ASN1DataType type, Int64 length)
+{
+	Byte bytes[9];
+	writeBytes( bytes, ASN1Encoder::encodeLength(length, bytes) );
+	writeByte( type );
+}
+
+void ASN1Writer::writeOctetString(const Byte *value, Int64 length)
+{
+	writeBytes( value, length );
+	writeHeader( ASN1TYPE_OCTETSTRING, length );
+}
+
+void ASN1Writer::writeObjectIdentifier(const OID &oid)
+{
+	assert( oid.count() > 1 );
+	Int64 contentsMark = mark();
+	Byte bytes[10];
+
+	// Backwards: from the last element to the 3rd one.
+	for( Int64 pos = oid.count()-1; pos >= 2; --pos )
+		writeBytes( bytes, ASN1Encoder::encodeObjectIdentifierValue(oid[pos].toULongLong(), bytes) );
+
+	// First 2 elements have special coding: 40x[0]+[1] in the first byte.
+	writeByte( static_cast<Byte>(oid[0].toULongLong() * 40 + oid[1].toULongLong()) );
+	writeHeader( ASN1TYPE_OBJECTID, mSize - contentsMark );
+}
+
+void ASN1Writer::writeNULL()
+{
+	writeByte( 0 );
+	writeByte( ASN1TYPE_NULL );
+}
+
+void ASN1Writer::writeIPv4Address(const Utils::IPv4Address &ipv4Address)
+{
+	writeByte( ipv4Address.octetD() );
+	writeByte( ipv4Address.octetC() );
+	writeByte( ipv4Address.octetB() );
+	writeByte( ipv4Address.octetA() );
+	writeHeader( ASN1TYPE_IPv4Address, 4 );
+}
+
+// Must write exactly the same as ASN1Encoder::encodeUnknown
+void ASN1Writer::writeUnknown(const ASN1Variable &asn1Var)
+{
+	switch( asn1Var.type() )
+	{
+	case ASN1TYPE_NULL:			writeNULL( );	return;
+	case ASN1TYPE_INTEGER:		writeInteger( asn1Var.toInteger(),		asn1Var.type(), false );	return;
+	case ASN1TYPE_Gauge32:		writeInteger( asn1Var.toGauge32(),		asn1Var.type(), true );		return;
+	case ASN1TYPE_Counter:		writeInteger( asn1Var.toCounter(),		asn1Var.type(), true );		return;
+	case ASN1TYPE_Counter64:	writeInteger( asn1Var.toCounter64(),	asn1Var.type(), true );		return;
+	case ASN1TYPE_Integer64:	writeInteger( asn1Var.toInteger64(),	asn1Var.type(), false );	return;
+	case ASN1TYPE_Unsigned64:	writeInteger( asn1Var.toUnsigned64(),	asn1Var.type(), false );	return;
+	case ASN1TYPE_OBJECTID:		writeObjectIdentifier( asn1Var.toOID() );		return;
+	case ASN1TYPE_OCTETSTRING:
+		{
+			ByteView view = asn1Var.octetStringView();
+			writeOctetString( view.bytes(), view.count() );
+		}
+		return;
+	case ASN1TYPE_IPv4Address:	writeIPv4Address( asn1Var.toIPV4() );			return;
+	default:
+		break;
+	}
+	assert(false);
+	writeNULL();
+}
@@ -0,0 +1,110 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef ASN1WRITER_H
+#define ASN1WRITER_H
+
+#include <cstring>
+
+#include "stdcharvector.h"
+#include "asn1types.h"
+#include "asn1variable.h"
+#include "asn1encoder.h"
+
+namespace SNMP {
+
+/*
+ * BER writer that fills the buffer from the end to the begining.
+ *
+ * Because data is written backwards, when a constructed type (sequence, PDU)
+ * header must be written, all its contents are already in the buffer and its
+ * length is known. So, there is no need to insert length bytes or to copy
+ * children into its parent.
+ *
+ * As a consequence, items must be written in reverse order: last varbind first,
+ * value before the OID and the contents before the header. To write a
+ * constructed type, keep the mark() before writing its contents and call
+ * writeList() or writeSequence() with it.
+ *
+ * If the buffer is too small (or null, used to compute the required size), the
+ * writer stops writting but keeps counting. So, size() always reports the
+ * needed size and overflow() tells if the data in buffer is usable.
+ */
+class ASN1Writer
+{
+	Byte *mBuffer;
+	Int64 mCapacity;
+	Int64 mSize;
+
+public:
+	ASN1Writer(Byte *buffer, Int64 capacity)
+		: mBuffer(buffer)
+		, mCapacity(buffer ? capacity : 0)
+		, mSize(0)
+	{	}
+
+	Int64 size() const		{ return mSize;				}
+	Int64 capacity() const	{ return mCapacity;			}
+	bool overflow() const	{ return mSize > mCapacity;	}
+	Int64 mark() const		{ return mSize;				}
+
+	// First byte of the written data. Only valid if there is no overflow.
+	const Byte *data() const	{ return mBuffer + (mCapacity - mSize);	}
+
+	void writeByte(Byte b)
+	{
+		if( ++mSize <= mCapacity )
+			mBuffer[mCapacity - mSize] = b;
+	}
+	void writeBytes(const Byte *b, Int64 length)
+	{
+		mSize += length;
+		if( (mSize <= mCapacity) && (length > 0) )
+			memcpy( mBuffer + (mCapacity - mSize), b, static_cast<size_t>(length) );
+	}
+	void writeHeader(ASN1DataType type, Int64 length);
+
+	template<typename T>
+	void writeInteger(T value, ASN1DataType type, bool isUnsigned)
+	{
+		Byte bytes[sizeof(T)+1];
+		int length = ASN1Encoder::encodeIntegerValue(value, isUnsigned, bytes);
+		writeBytes( bytes, length );
+		writeHeader( type, length );
+	}
+	void writeOctetString(const Byte *value, Int64 length);
+	void writeOctetString(const StdByteVector &value)	{ writeOctetString(value.bytes(), value.count());	}
+	void writeOctetString(const StdString &value)		{ writeOctetString(reinterpret_cast<const Byte*>(value.data()), static_cast<Int64>(value.size()));	}
+	void writeObjectIdentifier(const OID &oid);
+	void writeNULL();
+	void writeIPv4Address(const Utils::IPv4Address &ipv4Address);
+	void writeUnknown(const ASN1Variable &asn1Var);
+
+	// Writes the header of a constructed type which contents are
+	// all data written since contentsMark.
+	void writeList(ASN1DataType asn1Type, Int64 contentsMark)	{ writeHeader(asn1Type, mSize - contentsMark);	}
+	void writeSequence(Int64 contentsMark)						{ writeList(ASN1TYPE_Sequence, contentsMark);	}
+};
+
+} // namespace SNMP
+
+#endif // ASN1WRITER_H
@@ -0,0 +1,83 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef BYTEVIEW_H
+#define BYTEVIEW_H
+
+#include <cstring>
+
+#include "basic_types.h"
+#include "stdstring.h"
+#include "stdcharvector.h"
+
+namespace SNMP {
+
+// Non owning view over a piece of bytes. Used to look at received data
+// without copying it. The bytes must outlive the view.
+class ByteView
+{
+	const Byte *mBytes;
+	Int64 mCount;
+
+public:
+	ByteView()
+		: mBytes(nullptr)
+		, mCount(0)
+	{	}
+	ByteView(const Byte *bytes, Int64 count)
+		: mBytes(bytes)
+		, mCount(count)
+	{	}
+	ByteView(const StdByteVector &ba)
+		: mBytes(ba.bytes())
+		, mCount(ba.count())
+	{	}
+
+	const Byte *bytes() const	{ return mBytes;	}
+	const char *chars() const	{ return reinterpret_cast<const char*>(mBytes);	}
+	Int64 count() const			{ return mCount;	}
+	bool isEmpty() const		{ return mCount == 0;	}
+
+	Byte operator[](Int64 i) const	{ return mBytes[i];	}
+	const Byte *begin() const		{ return mBytes;	}
+	const Byte *end() const			{ return mBytes + mCount;	}
+
+	ByteView mid(Int64 pos, Int64 length) const
+	{
+		if( (pos + length) > mCount )
+			length = mCount - pos;
+		return ByteView(mBytes + pos, length);
+	}
+
+	StdByteVector toByteVector() const	{ return StdByteVector(chars(), mCount);	}
+	StdString toStdString() const		{ return StdString(chars(), static_cast<StdString::size_type>(mCount));	}
+
+	bool operator==(const ByteView &other) const
+	{
+		return (mCount == other.mCount) && ((mCount == 0) || !memcmp(mBytes, other.mBytes, static_cast<size_t>(mCount)));
+	}
+	bool operator!=(const ByteView &other) const	{ return !operator==(other);	}
+};
+
+} // namespace SNMP
+
+#endif // BYTEVIEW_H
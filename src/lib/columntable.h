@@ -0,0 +1,441 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef COLUMNTABLE_H
+#define COLUMNTABLE_H
+
+#include "snmptable.h"
+
+#include <unordered_map>
+
+namespace SNMP {
+
+/*
+ * Column of a ColumnTable. Values are kept in a contiguous array: numbers
+ * and IPv4 addresses as UInt64 and strings as ids of interned values.
+ * The column type is the one of the first value set. A bitmap tells the
+ * rows with a value in the array; cells of other types are kept apart.
+ * Rows without a value in the array hold 0, so numbers can be added up
+ * without checking the bitmap.
+ * Interned strings count its rows. The ones no row uses anymore are freed
+ * and its ids reused by the next strings.
+ */
+class TableColumn
+{
+public:
+	enum Kind : Byte
+	{
+		Untyped,	// No value yet.
+		Numbers,
+		Strings
+	};
+
+private:
+	ASN1DataType mType;
+	Kind mKind;
+	StdVector<UInt64> mValues;		// Number or string id, per row.
+	StdVector<UInt64> mValid;		// One bit per row.
+	StdVector<StdByteVector> mStrings;	// Interned strings, by id.
+	StdVector<UInt64> mStringUses;		// Rows using the string, by id.
+	StdVector<UInt64> mFreeIds;			// Ids of the strings freed.
+	std::unordered_multimap<UInt64, UInt64> mStringIds;	// String hash -> id.
+	std::unordered_map<Int64, ASN1Variable> mOthers;	// Cells of other types, by row.
+
+	static Kind kindOf(ASN1DataType type)
+	{
+		switch( ASN1Encoder::ValueKinds[type] )
+		{
+		case ASN1ValueKind::Number:
+		case ASN1ValueKind::IPv4Address:
+			return Numbers;
+		case ASN1ValueKind::OctetString:
+		case ASN1ValueKind::Data:
+			return Strings;
+		default:
+			return Untyped;
+		}
+	}
+	void setValid(Int64 row, bool valid)
+	{
+		UInt64 bit = 1ull << (row & 63);
+		if( valid )
+			mValid[row >> 6] |= bit;
+		else
+			mValid[row >> 6] &= ~bit;
+	}
+	UInt64 intern(const ByteView &bytes)
+	{
+		UInt64 hash = TableValueIndex::hash(bytes);
+		auto range = mStringIds.equal_range(hash);
+		for( auto it = range.first; it != range.second; ++it )
+		{
+			if( ByteView(mStrings[static_cast<Int64>(it->second)]) == bytes )
+			{
+				++mStringUses[static_cast<Int64>(it->second)];
+				return it->second;
+			}
+		}
+
+		UInt64 id;
+		if( mFreeIds.isEmpty() )
+		{
+			id = static_cast<UInt64>(mStrings.count());
+			mStrings.append( bytes.toByteVector() );
+			mStringUses.append(1);
+		}
+		else
+		{
+			id = mFreeIds.back();
+			mFreeIds.pop_back();
+			mStrings[static_cast<Int64>(id)] = bytes.toByteVector();
+			mStringUses[static_cast<Int64>(id)] = 1;
+		}
+		mStringIds.emplace(hash, id);
+		return id;
+	}
+	// Frees the string if no other row uses it.
+	void release(UInt64 id)
+	{
+		Int64 i = static_cast<Int64>(id);
+		if( --mStringUses[i] )
+			return;
+		auto range = mStringIds.equal_range( TableValueIndex::hash(ByteView(mStrings[i])) );
+		for( auto it = range.first; it != range.second; ++it )
+		{
+			if( it->second == id )
+			{
+				mStringIds.erase(it);
+				break;
+			}
+		}
+		mStrings[i] = StdByteVector();
+		mFreeIds.append(id);
+	}
+	// Releases the row string, if it has one.
+	void releaseRow(Int64 row)
+	{
+		if( (mKind == Strings) && isValid(row) )
+			release( mValues[row] );
+	}
+
+public:
+	TableColumn()
+		: mType(ASN1TYPE_NULL)
+		, mKind(Untyped)
+	{	}
+
+	ASN1DataType type() const	{ return mType;	}
+	Kind kind() const			{ return mKind;	}
+	Int64 count() const			{ return mValues.count();	}
+	// Interned strings in use.
+	Int64 stringCount() const	{ return mStrings.count() - mFreeIds.count();	}
+
+	// True if the row has its value in the array.
+	bool isValid(Int64 row) const	{ return (mValid[row >> 6] >> (row & 63)) & 1;	}
+	// True if the row has a value, in the array or not.
+	bool hasValue(Int64 row) const	{ return isValid(row) || mOthers.count(row);	}
+
+	// Numbers, or string ids, of all rows.
+	const UInt64 *values() const	{ return mValues.data();	}
+	UInt64 number(Int64 row) const	{ return mValues[row];	}
+	ByteView string(Int64 row) const
+	{
+		if( (mKind != Strings) || !isValid(row) )
+			return ByteView();
+		return ByteView( mStrings[static_cast<Int64>(mValues[row])] );
+	}
+	// Sum of the numbers of all rows.
+	UInt64 sum() const
+	{
+		UInt64 total = 0;
+		const UInt64 *values = mValues.data();
+		for( Int64 row = 0, rows = count(); row < rows; ++row )
+			total += values[row];
+		return total;
+	}
+
+	ASN1Variable cell(Int64 row) const
+	{
+		ASN1Variable value;
+		if( isValid(row) )
+		{
+			if( mKind == Numbers )
+			{
+				value.setUInteger( mValues[row] );
+				value.setType( mType );
+			}
+			else
+			{
+				const StdByteVector &bytes = mStrings[static_cast<Int64>(mValues[row])];
+				value.setData( mType, bytes.bytes(), bytes.count() );
+			}
+		}
+		else
+		{
+			auto it = mOthers.find(row);
+			if( it != mOthers.end() )
+				value = it->second;
+		}
+		return value;
+	}
+	// Null values clear the cell.
+	void setCell(Int64 row, const ASN1Variable &value)
+	{
+		Kind kind = kindOf( value.type() );
+		if( (mKind == Untyped) && (kind != Untyped) )
+		{
+			mKind = kind;
+			mType = value.type();
+		}
+		// The new string is interned before the old one is released, so
+		// setting the same string again doesn't free it.
+		bool inArray = (kind != Untyped) && (value.type() == mType);
+		UInt64 newValue = !inArray ? 0 : (kind == Numbers) ? value.toUInteger() : intern( value.octetStringView() );
+
+		releaseRow(row);
+		mValues[row] = newValue;
+		setValid(row, inArray);
+		mOthers.erase(row);
+		if( !inArray && (value.type() != ASN1TYPE_NULL) )
+			mOthers[row] = value;
+	}
+
+	void appendRow()
+	{
+		mValues.append(0);
+		if( mValid.count() * 64 < mValues.count() )
+			mValid.append(0);
+	}
+	void removeRow(Int64 row)
+	{
+		Int64 rows = count();
+		releaseRow(row);
+		mValues.erase( mValues.begin() + row );
+		for( Int64 r = row; r < rows - 1; ++r )
+			setValid( r, isValid(r + 1) );
+		setValid( rows - 1, false );
+
+		if( !mOthers.empty() )
+		{
+			std::unordered_map<Int64, ASN1Variable> others;
+			for( auto &entry : mOthers )
+				if( entry.first != row )
+					others.emplace( (entry.first > row) ? entry.first - 1 : entry.first, std::move(entry.second) );
+			mOthers.swap(others);
+		}
+	}
+	void clear()
+	{
+		mValues.clear();
+		mValid.clear();
+		mOthers.clear();
+		mStrings.clear();
+		mStringUses.clear();
+		mFreeIds.clear();
+		mStringIds.clear();
+	}
+};
+
+/*
+ * Table with the same layout than TableBase<T>, but stored by columns
+ * (see TableColumn) and keys (an array per key position). So, going over
+ * a column touches only its values. T is the row class of the TableBase
+ * table, used for its layout only.
+ * Rows are read by at(row).cell(col), like TableBase ones, but cells are
+ * copies. Rows are in key order too (see TableKeyOrder). As in TableBase,
+ * ordered queries sort the rows added since the last one, so call
+ * updateIndexes() before sharing the table with concurrent readers.
+ */
+template <class T>
+class ColumnTable : public TableBaseInfo<T>
+{
+	StdVector<TableColumn> mColumns;
+	StdVector<StdVector<UInt64>> mKeys;	// Key values, for every key position.
+	Int64 mCount;
+	TableKeyIndex mIndex;
+	mutable TableKeyOrder mOrder;
+
+public:
+	class Row
+	{
+		const ColumnTable *mTable;
+		Int64 mRow;
+
+	public:
+		Row(const ColumnTable *table, Int64 row)
+			: mTable(table)
+			, mRow(row)
+		{	}
+		Int64 row() const						{ return mRow;	}
+		ASN1Variable cell(Int64 col) const		{ return mTable->column(col).cell(mRow);	}
+		OIDValue key(Int64 keyIndex) const		{ return OIDValue( mTable->keyColumn(keyIndex)[mRow] );	}
+		OID keys() const						{ return mTable->keys(mRow);	}
+		bool machKeys(const OID &oid) const		{ return mTable->machKeys(mRow, oid);	}
+		OID cellOID(Int64 col) const
+		{
+			OID oid;
+			oid.reserve( ColumnTable::oidBase().count() + 1 + ColumnTable::keyCount() );
+			oid.append( ColumnTable::oidBase() );
+			oid.append( OIDValue(col) );
+			oid.append( keys() );
+			return oid;
+		}
+		PDUVarbind varbind(Int64 col) const		{ return PDUVarbind( cellOID(col), cell(col) );	}
+	};
+
+	ColumnTable(int dataId)
+		: TableBaseInfo<T>(dataId)
+		, mCount(0)
+	{
+		mColumns.resize( ColumnTable::columnCount() );
+		mKeys.resize( ColumnTable::keyCount() );
+		mIndex.clear( ColumnTable::keyCount() );
+	}
+
+	Int64 count() const		{ return mCount;		}
+	bool isEmpty() const	{ return mCount == 0;	}
+	void clear()
+	{
+		for( TableColumn &column : mColumns )
+			column.clear();
+		for( StdVector<UInt64> &keys : mKeys )
+			keys.clear();
+		mIndex.clear( ColumnTable::keyCount() );
+		mOrder.clear();
+		mCount = 0;
+	}
+
+	const TableColumn &column(Int64 col) const			{ return mColumns.at( col - ColumnTable::firstColumn() );	}
+	const StdVector<UInt64> &keyColumn(Int64 keyIndex) const	{ return mKeys.at(keyIndex);	}
+	OID keys(Int64 row) const
+	{
+		OID keys;
+		keys.reserve( ColumnTable::keyCount() );
+		for( const StdVector<UInt64> &keyColumn : mKeys )
+			keys.append( OIDValue(keyColumn[row]) );
+		return keys;
+	}
+	bool machKeys(Int64 row, const OID &oid) const
+	{
+		Int64 first = oid.count() - ColumnTable::keyCount();
+		if( first < 0 )
+			return false;
+		for( Int64 k = 0; k < ColumnTable::keyCount(); ++k )
+			if( mKeys[k][row] != oid[first + k].toULongLong() )
+				return false;
+		return true;
+	}
+
+	Row at(Int64 row) const		{ return Row(this, row);	}
+	ASN1Variable cell(Int64 row, Int64 col) const	{ return column(col).cell(row);	}
+
+	Int64 rowOf(const OID &oid) const
+	{
+		if( oid.count() < ColumnTable::keyCount() )
+			return -1;
+		UInt64 keysHash = TableKeyIndex::hash( oid.data() + (oid.count() - ColumnTable::keyCount()), ColumnTable::keyCount() );
+		return mIndex.find( keysHash, [this, &oid](Int64 row) { return machKeys(row, oid); } );
+	}
+	Int64 rowOf(const PDUVarbind &varBind) const
+	{
+		if( varBind.oid().startsWith(ColumnTable::oidBase()) )
+			return rowOf( varBind.oid() );
+		return -1;
+	}
+
+	// Same as TableBase::setCellData.
+	Int64 setCellData(const PDUVarbind &varBind)
+	{
+		if( varBind.oid().startsWith(ColumnTable::oidBase()) )
+		{
+			Int64 col = static_cast<Int64>(varBind.oid().at(ColumnTable::oidBase().count()).toULongLong());
+			if( col < ColumnTable::firstColumn() )
+				std::cerr << __func__ << " column " << col << ", in the OID " << varBind.oid().toStdString() << ", is less than the first configured: " << ColumnTable::firstColumn() << std::endl;
+			else
+			if( col > ColumnTable::lastColumn() )
+				std::cerr << __func__ << " column " << col << ", in the OID " << varBind.oid().toStdString() << ", is greater than the last configured: " << ColumnTable::lastColumn() << std::endl;
+			else
+			{
+				Int64 row = rowOf( varBind.oid() );
+
+				if( row == -1 )
+				{
+					row = mCount++;
+					for( TableColumn &column : mColumns )
+						column.appendRow();
+					for( Int64 key = 0; key < ColumnTable::keyCount(); ++key )
+						mKeys[key].append( ColumnTable::oidKeyValue(varBind.oid(), static_cast<int>(key)).toULongLong() );
+					mIndex.insert( keys(row), row );
+					mOrder.insert(row);
+				}
+				mColumns[col - ColumnTable::firstColumn()].setCell( row, varBind.asn1Variable() );
+				return row;
+			}
+		}
+		return -1;
+	}
+	void removeRow(Int64 row)
+	{
+		if( (row >= 0) && (row < mCount) )
+		{
+			mIndex.remove( keys(row), row );
+			mOrder.remove(row);
+			for( TableColumn &column : mColumns )
+				column.removeRow(row);
+			for( StdVector<UInt64> &keyColumn : mKeys )
+				keyColumn.erase( keyColumn.begin() + row );
+			--mCount;
+		}
+	}
+	void removeRow(const PDUVarbind &varBind)
+	{
+		removeRow( rowOf(varBind) );
+	}
+
+	// Same as the TableBase ones.
+	void updateIndexes()	{ orderedRows();	}
+	const StdVector<Int64> &orderedRows() const
+	{
+		return mOrder.rows( ColumnTable::keyCount(), [this](Int64 row, Int64 k) { return mKeys[k][row]; } );
+	}
+	Int64 nextRow(const OID &keys) const
+	{
+		auto keyAt = [this](Int64 row, Int64 k) { return mKeys[k][row]; };
+		Int64 pos = mOrder.upperBound( ColumnTable::keyCount(), keyAt, keys );
+		const StdVector<Int64> &rows = mOrder.rows( ColumnTable::keyCount(), keyAt );
+		return (pos < rows.count()) ? rows[pos] : -1;
+	}
+	std::pair<Int64, Int64> keyRange(const OID &prefix) const
+	{
+		return mOrder.prefixRange( ColumnTable::keyCount(), [this](Int64 row, Int64 k) { return mKeys[k][row]; }, prefix );
+	}
+
+	Int64 keyRow( Int64 keyIndex, const OIDValue &oid ) const
+	{
+		assert(keyIndex < ColumnTable::keyCount());
+		return mIndex.keyRow( keyIndex, oid.toULongLong() );
+	}
+};
+
+}	// namespace SNMP
+
+#endif // COLUMNTABLE_H
@@ -0,0 +1,222 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef COMPACTOID_H
+#define COMPACTOID_H
+
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+#include <stdexcept>
+
+#include "basic_types.h"
+#include "oid.h"
+
+namespace SNMP {
+
+/*
+ * Compact OID to store lots of them.
+ *
+ * Arcs are packed 32 bits values (SNMP sub-identifiers are limited to 32 bits)
+ * and, up to InlineArcs, are stored into the object itself. So, usual OIDs
+ * don't need any heap allocation. Comparisons are just a memcmp.
+ *
+ * Converts from/to OID so it can be used wherever an OID is expected.
+ */
+class CompactOID
+{
+public:
+	typedef UInt32 Arc;
+	enum { InlineArcs = 22 };
+
+private:
+	UInt32 mCount;
+	UInt32 mCapacity;
+	union
+	{
+		Arc inlineArcs[InlineArcs];
+		Arc *heapArcs;
+	} mArcs;
+
+	bool isInline() const	{ return mCapacity <= InlineArcs;	}
+
+public:
+	CompactOID()
+		: mCount(0)
+		, mCapacity(InlineArcs)
+	{	}
+	CompactOID(std::initializer_list<Arc> arcs)
+		: CompactOID()
+	{
+		reserve( static_cast<Int64>(arcs.size()) );
+		for( Arc arc : arcs )
+			append( arc );
+	}
+	// OIDs with arcs over 32 bits are not SNMP ones and cannot be stored:
+	// throws std::out_of_range, as OID text constructors do.
+	explicit CompactOID(const OID &oid)
+		: CompactOID()
+	{
+		for( const OIDValue &v : oid )
+			if( v.toULongLong() > 0xFFFFFFFFu )
+				throw std::out_of_range( "OID arc over 32 bits: " + v.toStdString() );
+		reserve( oid.count() );
+		for( const OIDValue &v : oid )
+			append( static_cast<Arc>(v.toULongLong()) );
+	}
+	CompactOID(const char *oid)
+		: CompactOID( OID(oid) )
+	{	}
+	CompactOID(const StdString &oid)
+		: CompactOID( OID(oid) )
+	{	}
+	CompactOID(const CompactOID &other)
+		: CompactOID()
+	{
+		*this = other;
+	}
+	CompactOID(CompactOID &&other)
+		: CompactOID()
+	{
+		*this = std::move(other);
+	}
+	~CompactOID()
+	{
+		if( !isInline() )
+			delete [] mArcs.heapArcs;
+	}
+	CompactOID &operator=(const CompactOID &other)
+	{
+		if( this != &other )
+		{
+			mCount = 0;
+			reserve( other.mCount );
+			memcpy( arcs(), other.arcs(), other.mCount * sizeof(Arc) );
+			mCount = other.mCount;
+		}
+		return *this;
+	}
+	CompactOID &operator=(CompactOID &&other)
+	{
+		if( this != &other )
+		{
+			if( other.isInline() )
+				return operator=(static_cast<const CompactOID &>(other));
+			if( !isInline() )
+				delete [] mArcs.heapArcs;
+			mArcs.heapArcs = other.mArcs.heapArcs;
+			mCount = other.mCount;
+			mCapacity = other.mCapacity;
+			other.mCount = 0;
+			other.mCapacity = InlineArcs;
+		}
+		return *this;
+	}
+
+	Int64 count() const		{ return mCount;		}
+	bool isEmpty() const	{ return mCount == 0;	}
+	void clear()			{ mCount = 0;			}
+
+	const Arc *arcs() const	{ return isInline() ? mArcs.inlineArcs : mArcs.heapArcs;	}
+	Arc *arcs()				{ return isInline() ? mArcs.inlineArcs : mArcs.heapArcs;	}
+	const Arc *begin() const	{ return arcs();			}
+	const Arc *end() const		{ return arcs() + mCount;	}
+
+	Arc at(Int64 i) const			{ assert( (i >= 0) && (i < mCount) ); return arcs()[i];	}
+	Arc operator[](Int64 i) const	{ return at(i);	}
+	Arc &operator[](Int64 i)		{ assert( (i >= 0) && (i < mCount) ); return arcs()[i];	}
+
+	void reserve(Int64 capacity)
+	{
+		if( capacity > mCapacity )
+		{
+			Arc *newArcs = new Arc[static_cast<size_t>(capacity)];
+			memcpy( newArcs, arcs(), mCount * sizeof(Arc) );
+			if( !isInline() )
+				delete [] mArcs.heapArcs;
+			mArcs.heapArcs = newArcs;
+			mCapacity = static_cast<UInt32>(capacity);
+		}
+	}
+	void append(Arc arc)
+	{
+		if( mCount == mCapacity )
+			reserve( mCapacity * 2 );
+		arcs()[mCount++] = arc;
+	}
+	void append(const CompactOID &oid)
+	{
+		reserve( mCount + oid.mCount );
+		memcpy( arcs() + mCount, oid.arcs(), oid.mCount * sizeof(Arc) );
+		mCount += oid.mCount;
+	}
+
+	bool startsWith(const CompactOID &oid) const
+	{
+		return (oid.mCount <= mCount) && !memcmp( arcs(), oid.arcs(), oid.mCount * sizeof(Arc) );
+	}
+	bool endsWith(const CompactOID &oid) const
+	{
+		return (oid.mCount <= mCount) && !memcmp( arcs() + (mCount - oid.mCount), oid.arcs(), oid.mCount * sizeof(Arc) );
+	}
+	bool operator==(const CompactOID &oid) const	{ return (oid.mCount == mCount) && startsWith(oid);	}
+	bool operator!=(const CompactOID &oid) const	{ return !operator==(oid);	}
+	// Lexicographic order. The same as SNMP GetNext order.
+	bool operator<(const CompactOID &oid) const
+	{
+		UInt32 n = mCount < oid.mCount ? mCount : oid.mCount;
+		for( UInt32 i = 0; i < n; ++i )
+			if( arcs()[i] != oid.arcs()[i] )
+				return arcs()[i] < oid.arcs()[i];
+		return mCount < oid.mCount;
+	}
+
+	OID toOID() const
+	{
+		OID oid;
+		oid.reserve( mCount );
+		for( Arc arc : *this )
+			oid.append( OIDValue(arc) );
+		return oid;
+	}
+	operator OID() const	{ return toOID();	}
+
+	void appendTo(StdString &out) const
+	{
+		for( Arc arc : *this )
+		{
+			out.push_back('.');
+			Utils::appendUnsigned(out, arc);
+		}
+	}
+	StdString toStdString() const
+	{
+		StdString rtn;
+		rtn.reserve( static_cast<StdString::size_type>(mCount) * 4 );
+		appendTo(rtn);
+		return rtn;
+	}
+};
+
+} // namespace SNMP
+
+#endif // COMPACTOID_H
@@ -0,0 +1,283 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#include "messageview.h"
+
+using namespace SNMP;
+
+// Reads type and length of data already validated.
+static inline const Byte *readHeader(const Byte *p, ASN1DataType &type, Int64 &length)
+{
+	type = *p++;
+	if( !(*p & 0x80) )
+		length = *p++;
+	else
+	{
+		int count = *p++ & 0x7F;
+		length = 0;
+		while( count-- > 0 )
+			length = (length << 8) | *p++;
+	}
+	return p;
+}
+
+// Reads type and length checking that data fits before end and the type is the expected one.
+static bool getTLVData(ASN1Encoder::ErrorCode &errorCode, const Byte *data, Int64 end, Int64 &pos, ASN1DataType validType, Int64 &length)
+{
+	ASN1DataType type;
+	if( !ASN1Encoder::getRawTLVData(errorCode, data, end, pos, type, length) )
+		return false;
+	if( type != validType )
+	{
+		errorCode = ASN1Encoder::ErrorCode::WrongType;
+		return false;
+	}
+	return true;
+}
+
+static bool decodeInteger(ASN1Encoder::ErrorCode &errorCode, const Byte *data, Int64 end, Int64 &pos, Int32 &value, bool isUnsigned)
+{
+	Int64 length;
+	if( !getTLVData(errorCode, data, end, pos, ASN1TYPE_INTEGER, length) ||
+		!ASN1Encoder::decodeRawInteger(errorCode, value, data + pos, length, isUnsigned) )
+		return false;
+	pos += length;
+	return true;
+}
+
+bool MessageView::Varbind::oidStartsWith(const OID &oid) const
+{
+	if( oid.count() == 0 )
+		return true;
+	if( mOID.isEmpty() )
+		return false;
+
+	// First 2 elements have special coding: 40x[0]+[1] in the first byte.
+	if( oid[0] != (mOID[0] / 40) )
+		return false;
+	if( (oid.count() > 1) && (oid[1] != (mOID[0] % 40)) )
+		return false;
+
+	Int64 i = 2;
+	UInt64 value = 0;
+	for( Int64 pos = 1; (pos < mOID.count()) && (i < oid.count()); ++pos )
+	{
+		value = (value << 7) | (mOID[pos] & 0x7F);
+		if( !(mOID[pos] & 0x80) )
+		{
+			if( oid[i++] != value )
+				return false;
+			value = 0;
+		}
+	}
+	return i >= oid.count();
+}
+
+bool MessageView::Varbind::decodeOID(ASN1Encoder::ErrorCode &errorCode, OID &oid) const
+{
+	return ASN1Encoder::decodeRawObjectIdentifier(errorCode, oid, mOID.bytes(), mOID.count());
+}
+
+OID MessageView::Varbind::oid() const
+{
+	OID oid;
+	ASN1Encoder::ErrorCode errorCode;
+	decodeOID(errorCode, oid);
+	return oid;
+}
+
+bool MessageView::Varbind::decodeValue(ASN1Encoder::ErrorCode &errorCode, ASN1Variable &asn1Var) const
+{
+	return ASN1Encoder::decodeRawUnknown(errorCode, mValue.bytes(), mValue.count(), mValueType, asn1Var);
+}
+
+ASN1Variable MessageView::Varbind::asn1Variable() const
+{
+	ASN1Variable asn1Var;
+	ASN1Encoder::ErrorCode errorCode;
+	decodeValue(errorCode, asn1Var);
+	return asn1Var;
+}
+
+bool MessageView::Varbind::decodeVarbind(ASN1Encoder::ErrorCode &errorCode, PDUVarbind &varbind, bool includeRawData) const
+{
+	bool ok = decodeVarbind( errorCode, varbind, SharedDatagram() );
+	// Varbinds constructed with a resource keep all its data in it.
+	if( ok && includeRawData )
+		varbind.setRawValue( RawValue(makeSharedDatagram(mValue.bytes(), mValue.count(), varbind.resource()), 0, mValue.count()) );
+	return ok;
+}
+
+bool MessageView::Varbind::decodeVarbind(ASN1Encoder::ErrorCode &errorCode, PDUVarbind &varbind, const SharedDatagram &datagram) const
+{
+	if( datagram )
+		varbind.setRawValue( RawValue(datagram, mValueOffset, mValue.count()) );
+	else
+		varbind.rawValue().clear();
+
+	if( decodeOID(errorCode, varbind.oid()) &&
+		ASN1Encoder::decodeRawUnknown(errorCode, mValue.bytes(), mValue.count(), mValueType, varbind.asn1Variable(), varbind.resource()) )
+		return true;
+
+	// Nothing of the varbind decoded before in the same storage must be left.
+	varbind.oid().clear();
+	varbind.asn1Variable().setNull();
+	varbind.rawValue().clear();
+	return false;
+}
+
+void MessageView::const_iterator::read()
+{
+	if( mPos == mEnd )
+		return;
+
+	ASN1DataType type;
+	Int64 length;
+	const Byte *p = readHeader(mPos, type, length);
+	mNext = p + length;
+
+	p = readHeader(p, type, length);
+	mVarbind.mOID = ByteView(p, length);
+	p = readHeader(p + length, mVarbind.mValueType, length);
+	mVarbind.mValue = ByteView(p, length);
+	mVarbind.mValueOffset = p - mDatagram;
+}
+
+MessageView::const_iterator &MessageView::const_iterator::operator++()
+{
+	mPos = mNext;
+	read();
+	return *this;
+}
+
+void MessageView::clear()
+{
+	mDatagram.reset();
+	mData = nullptr;
+	mSize = 0;
+	mErrorCode = ASN1Encoder::ErrorCode::NoError;
+	mVersion = 0;
+	mComunity = ByteView();
+	mRequestType = 0;
+	mRequestID = 0;
+	mErrorStatus = 0;
+	mErrorObjectIndex = 0;
+	mVarbindList = ByteView();
+	mVarbindCount = 0;
+}
+
+bool MessageView::parse(const Byte *data, Int64 size)
+{
+	Int64 pos = 0;
+	Int64 length;
+	ASN1DataType type;
+
+	clear();
+	mData = data;
+	mSize = size;
+
+	if( !getTLVData(mErrorCode, data, size, pos, ASN1TYPE_Sequence, length) )
+		return false;
+	Int64 end = pos + length;
+
+	if( !decodeInteger(mErrorCode, data, end, pos, mVersion, true) )
+		return false;
+
+	// Comunity.
+	if( !getTLVData(mErrorCode, data, end, pos, ASN1TYPE_OCTETSTRING, length) )
+		return false;
+	mComunity = ByteView(data + pos, length);
+	pos += length;
+
+	// PDU. Trap PDU (SNMPv1) has another structure.
+	if( !ASN1Encoder::getRawTLVData(mErrorCode, data, end, pos, type, length) )
+		return false;
+	if( !ASN1Encoder::MessagePDUTypes[type] )
+	{
+		mErrorCode = ASN1Encoder::ErrorCode::WrongType;
+		return false;
+	}
+	mRequestType = type;
+	end = pos + length;
+
+	if( !decodeInteger(mErrorCode, data, end, pos, mRequestID, false) ||
+		!decodeInteger(mErrorCode, data, end, pos, mErrorStatus, false) ||
+		!decodeInteger(mErrorCode, data, end, pos, mErrorObjectIndex, false) )
+		return false;
+
+	if( !getTLVData(mErrorCode, data, end, pos, ASN1TYPE_Sequence, length) )
+		return false;
+	mVarbindList = ByteView(data + pos, length);
+
+	if( !parseVarbindList() )
+	{
+		mVarbindList = ByteView();
+		mVarbindCount = 0;
+		return false;
+	}
+	return true;
+}
+
+bool MessageView::parse(SharedDatagram datagram)
+{
+	bool ok = datagram ? parse(datagram->bytes(), datagram->count()) : parse(nullptr, 0);
+	mDatagram = std::move(datagram);
+	return ok;
+}
+
+bool MessageView::parseVarbindList()
+{
+	const Byte *data = mVarbindList.bytes();
+	Int64 size = mVarbindList.count();
+	Int64 pos = 0;
+	Int64 length;
+	ASN1DataType type;
+
+	while( pos < size )
+	{
+		if( !getTLVData(mErrorCode, data, size, pos, ASN1TYPE_Sequence, length) )
+			return false;
+		Int64 varbindEnd = pos + length;
+
+		if( !getTLVData(mErrorCode, data, varbindEnd, pos, ASN1TYPE_OBJECTID, length) )
+			return false;
+		// Last byte cannot have the "more bytes" flag.
+		if( (length < 1) || (data[pos + length - 1] & 0x80) )
+		{
+			mErrorCode = ASN1Encoder::ErrorCode::WrongEncoding;
+			return false;
+		}
+		pos += length;
+
+		if( !ASN1Encoder::getRawTLVData(mErrorCode, data, varbindEnd, pos, type, length) )
+			return false;
+		pos += length;
+
+		if( pos != varbindEnd )
+		{
+			mErrorCode = ASN1Encoder::ErrorCode::WrongLength;
+			return false;
+		}
+		mVarbindCount++;
+	}
+	return true;
+}
@@ -0,0 +1,269 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef MESSAGEVIEW_H
+#define MESSAGEVIEW_H
+
+#include <cstddef>
+#include <iterator>
+
+#include "byteview.h"
+#include "asn1types.h"
+#include "asn1variable.h"
+#include "asn1encoder.h"
+#include "oid.h"
+#include "pduvarbind.h"
+#include "rawvalue.h"
+
+namespace SNMP {
+
+/*
+ * Zero-copy decoder for a received SNMP message.
+ *
+ * The whole datagram structure is validated once, when parsed. After that,
+ * version, comunity, request ID and errors are available and varbinds can be
+ * iterated. Nothing is copied: comunity, OIDs and values are views into the
+ * datagram. So, datagram must outlive the MessageView and its varbinds.
+ * A MessageView built from a SharedDatagram keeps it alive itself and the raw
+ * values of the varbinds decoded from it just point into it.
+ *
+ * OIDs and values are decoded only if asked for, so the caller
+ * can look at the parts it cares about without any allocation.
+ */
+class MessageView
+{
+public:
+	class Varbind
+	{
+		ByteView mOID;			// OID bytes, without type nor length.
+		ASN1DataType mValueType;
+		ByteView mValue;		// Value bytes, without type nor length.
+		Int64 mValueOffset;		// Value position in the datagram.
+
+		friend class MessageView;
+
+	public:
+		Varbind()
+			: mValueType(ASN1TYPE_NULL)
+			, mValueOffset(0)
+		{	}
+		const ByteView &oidBytes() const	{ return mOID;			}
+		ASN1DataType valueType() const		{ return mValueType;	}
+		const ByteView &valueBytes() const	{ return mValue;		}
+		Int64 valueOffset() const			{ return mValueOffset;	}
+
+		// Compares the OID without decoding it.
+		bool oidStartsWith(const OID &oid) const;
+		bool decodeOID(ASN1Encoder::ErrorCode &errorCode, OID &oid) const;
+		OID oid() const;
+		bool decodeValue(ASN1Encoder::ErrorCode &errorCode, ASN1Variable &asn1Var) const;
+		ASN1Variable asn1Variable() const;
+		// Decodes OID and value into varbind. Its storage is reused.
+		// The raw value gets its own copy of the bytes.
+		// On errors, varbind is left with an empty OID and a Null value.
+		bool decodeVarbind(ASN1Encoder::ErrorCode &errorCode, PDUVarbind &varbind, bool includeRawData) const;
+		// Same, but the raw value points into datagram, that must be the
+		// one parsed (see MessageView::sharedDatagram()). Null for no raw value.
+		bool decodeVarbind(ASN1Encoder::ErrorCode &errorCode, PDUVarbind &varbind, const SharedDatagram &datagram) const;
+	};
+
+	class const_iterator
+	{
+		const Byte *mPos;
+		const Byte *mNext;
+		const Byte *mEnd;
+		const Byte *mDatagram;
+		Varbind mVarbind;
+
+		void read();
+
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef Varbind value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const Varbind *pointer;
+		typedef const Varbind &reference;
+
+		const_iterator(const Byte *pos = nullptr, const Byte *end = nullptr, const Byte *datagram = nullptr)
+			: mPos(pos)
+			, mNext(pos)
+			, mEnd(end)
+			, mDatagram(datagram)
+		{
+			read();
+		}
+		const Varbind &operator*() const	{ return mVarbind;	}
+		const Varbind *operator->() const	{ return &mVarbind;	}
+		const_iterator &operator++();
+		// Skips the varbinds left.
+		void toEnd()	{ mPos = mNext = mEnd;	}
+		const_iterator operator++(int)		{ const_iterator rtn(*this); ++(*this); return rtn;	}
+		bool operator==(const const_iterator &other) const	{ return mPos == other.mPos;	}
+		bool operator!=(const const_iterator &other) const	{ return mPos != other.mPos;	}
+	};
+
+	// Iterates over varbinds as PDUVarbind, but each one is decoded only
+	// when dereferenced. So, stopping the loop early costs nothing
+	// and view() allows to look at the varbind without decoding it.
+	// A varbind that cannot be decoded has an empty OID and a Null value
+	// (see isValid()) and the iteration ends after it.
+	class VarbindIterator
+	{
+		const_iterator mIt;
+		SharedDatagram mDatagram;
+		mutable PDUVarbind mVarbind;
+		mutable bool mDecoded;
+		mutable ASN1Encoder::ErrorCode mErrorCode;
+
+		void decode() const
+		{
+			if( !mDecoded )
+			{
+				mErrorCode = ASN1Encoder::ErrorCode::NoError;
+				mIt->decodeVarbind(mErrorCode, mVarbind, mDatagram);
+				mDecoded = true;
+			}
+		}
+
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef PDUVarbind value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const PDUVarbind *pointer;
+		typedef const PDUVarbind &reference;
+
+		// Raw values point into datagram. Null for no raw values.
+		VarbindIterator(const const_iterator &it = const_iterator(), SharedDatagram datagram = SharedDatagram())
+			: mIt(it)
+			, mDatagram(std::move(datagram))
+			, mDecoded(false)
+			, mErrorCode(ASN1Encoder::ErrorCode::NoError)
+		{	}
+		const Varbind &view() const		{ return *mIt;	}
+		const PDUVarbind &operator*() const		{ decode(); return mVarbind;	}
+		const PDUVarbind *operator->() const	{ return &operator*();	}
+		// False if the varbind cannot be decoded.
+		bool isValid() const							{ decode(); return mErrorCode == ASN1Encoder::ErrorCode::NoError;	}
+		ASN1Encoder::ErrorCode errorCode() const		{ decode(); return mErrorCode;	}
+		VarbindIterator &operator++()
+		{
+			if( mDecoded && (mErrorCode != ASN1Encoder::ErrorCode::NoError) )
+				mIt.toEnd();
+			else
+				++mIt;
+			mDecoded = false;
+			return *this;
+		}
+		VarbindIterator operator++(int)			{ VarbindIterator rtn(*this); ++(*this); return rtn;	}
+		bool operator==(const VarbindIterator &other) const	{ return mIt == other.mIt;	}
+		bool operator!=(const VarbindIterator &other) const	{ return mIt != other.mIt;	}
+	};
+	class VarbindRange
+	{
+		VarbindIterator mBegin;
+		VarbindIterator mEnd;
+
+	public:
+		VarbindRange(const VarbindIterator &b, const VarbindIterator &e)
+			: mBegin(b)
+			, mEnd(e)
+		{	}
+		const VarbindIterator &begin() const	{ return mBegin;	}
+		const VarbindIterator &end() const		{ return mEnd;		}
+	};
+
+private:
+	SharedDatagram mDatagram;
+	const Byte *mData;
+	Int64 mSize;
+	ASN1Encoder::ErrorCode mErrorCode;
+	Int32 mVersion;
+	ByteView mComunity;
+	ASN1DataType mRequestType;
+	Int32 mRequestID;
+	Int32 mErrorStatus;
+	Int32 mErrorObjectIndex;
+	ByteView mVarbindList;
+	Int64 mVarbindCount;
+
+	bool parseVarbindList();
+
+public:
+	MessageView()
+	{
+		clear();
+	}
+	MessageView(const Byte *data, Int64 size)
+	{
+		parse(data, size);
+	}
+	explicit MessageView(const StdByteVector &ba)
+	{
+		parse(ba.bytes(), ba.count());
+	}
+	explicit MessageView(SharedDatagram datagram)
+	{
+		parse(std::move(datagram));
+	}
+	void clear();
+	// Validates the whole datagram. Returns false if it's malformed.
+	bool parse(const Byte *data, Int64 size);
+	bool parse(const StdByteVector &ba)	{ return parse(ba.bytes(), ba.count());	}
+	// Same, keeping the datagram alive.
+	bool parse(SharedDatagram datagram);
+
+	const Byte *data() const	{ return mData;	}
+	Int64 size() const			{ return mSize;	}
+	// Datagram parsed, if given as SharedDatagram. Null otherwise.
+	const SharedDatagram &datagram() const	{ return mDatagram;	}
+	// Datagram parsed or, if not given as SharedDatagram, a copy of it taken
+	// from resource. Raw values of the decoded varbinds point into it.
+	SharedDatagram sharedDatagram(MemoryResource *resource = nullptr) const
+	{
+		return mDatagram ? mDatagram : makeSharedDatagram(mData, mSize, resource);
+	}
+
+	bool isValid() const	{ return mErrorCode == ASN1Encoder::ErrorCode::NoError;	}
+	// Decoding error. Remote error is in errorStatus()
+	ASN1Encoder::ErrorCode errorCode() const	{ return mErrorCode;	}
+
+	Int32 version() const				{ return mVersion;			}
+	const ByteView &comunity() const	{ return mComunity;			}
+	ASN1DataType requestType() const	{ return mRequestType;		}
+	Int32 requestID() const				{ return mRequestID;		}
+	ASN1Encoder::ErrorCode errorStatus() const	{ return static_cast<ASN1Encoder::ErrorCode>(mErrorStatus);	}
+	Int32 errorObjectIndex() const		{ return mErrorObjectIndex;	}
+
+	Int64 varbindCount() const	{ return mVarbindCount;	}
+	const_iterator begin() const	{ return const_iterator(mVarbindList.begin(), mVarbindList.end(), mData);	}
+	const_iterator end() const		{ return const_iterator(mVarbindList.end(), mVarbindList.end(), mData);	}
+
+	// Lazy decoded varbinds: for( const PDUVarbind &varbind : message.varbinds() )
+	VarbindRange varbinds(bool includeRawData = false) const
+	{
+		return VarbindRange( VarbindIterator(begin(), includeRawData ? sharedDatagram() : SharedDatagram()), VarbindIterator(end()) );
+	}
+};
+
+} // namespace SNMP
+
+#endif // MESSAGEVIEW_H
@@ -23,6 +23,9 @@
 #ifndef OID_H
 #define OID_H
 
+#include <cstring>
+#include <stdexcept>
+
 #include "../utils.h"
 #include "types.h"
 
@@ -30,7 +33,6 @@ namespace SNMP {
 
 class OIDValue
 {
-	StdString mStringValue;
 	UInt64 mValue;
 
 public:
@@ -38,8 +40,7 @@ public:
 	    : mValue(0)
 	{	}
 	explicit OIDValue(const char *v)
-		: mStringValue( v )
-		, mValue( std::stoull(v) )
+		: mValue( std::stoull(v) )
 	{	}
 	explicit OIDValue(const StdString &s)
 		: OIDValue( s.data() )
@@ -51,9 +52,11 @@ public:
 
 	StdString toStdString() const
 	{
-		if( mStringValue.length() == 0 )
-			const_cast<OIDValue&>(*this).mStringValue = std::to_string(mValue);
-		return mStringValue;
+		return std::to_string(mValue);
+	}
+	void appendTo(StdString &out) const
+	{
+		Utils::appendUnsigned(out, mValue);
 	}
 	UInt64 toULongLong() const
 	{
@@ -68,11 +71,16 @@ public:
 	bool operator ==(const OIDValue &v) const		{ return v.mValue == mValue;		}
 	bool operator !=(const OIDValue &v) const		{ return v.mValue != mValue;		}
 };
+// OID functions compare arcs with memcmp.
+static_assert( sizeof(OIDValue) == sizeof(UInt64), "OIDValue must be just the number" );
 
 class OID : public StdVector<OIDValue>
 {
 public:
 	OID() = default;
+	explicit OID( const Allocator<OIDValue> &allocator )
+		: StdVector(allocator)
+	{	}
 	OID( Int64 initialSize )
 		: StdVector(initialSize)
 	{	}
@@ -86,12 +94,78 @@ public:
 		for( StdString bit : oid )
 			at(i++) = OIDValue(bit);
 	}
+	// Throws, as std::stoull does, if text is not a valid OID: std::out_of_range
+	// if an arc doesn't fit into 64 bits and std::invalid_argument otherwise.
+	// Use parse() to check texts without exceptions.
 	OID( const char *charStr )
-		: OID( Utils::split( StdString(charStr), '.') )
-	{	}
+	{
+		parseOrThrow(charStr, static_cast<Int64>(strlen(charStr)));
+	}
 	OID( const StdString &s )
-		: OID( Utils::split(s, '.') )
-	{	}
+	{
+		parseOrThrow(s.data(), static_cast<Int64>(s.size()));
+	}
+
+	// Parses text like "1.3.6.1" or ".1.3.6.1" into oid, in a single pass and
+	// without any temporary. Empty arcs are skipped, as "1..3" is "1.3".
+	// Returns false if there is any character other than digits and dots or
+	// an arc doesn't fit into 64 bits. In that case, oid is left empty and
+	// errorPos, if not null, is set to the offending character position.
+	static bool parse(const char *text, Int64 length, OID &oid, Int64 *errorPos = nullptr)
+	{
+		oid.clear();
+		// There cannot be more arcs than half the text.
+		oid.reserve( (length + 1) / 2 );
+
+		UInt64 value = 0;
+		bool inArc = false;
+		for( Int64 pos = 0; pos < length; ++pos )
+		{
+			char c = text[pos];
+			if( c == '.' )
+			{
+				if( inArc )
+					oid.push_back( OIDValue(value) );
+				value = 0;
+				inArc = false;
+			}
+			else
+			if( (c >= '0') && (c <= '9') && (value <= (~static_cast<UInt64>(0) - static_cast<UInt64>(c - '0')) / 10) )
+			{
+				value = value * 10 + static_cast<UInt64>(c - '0');
+				inArc = true;
+			}
+			else
+			{
+				oid.clear();
+				if( errorPos != nullptr )
+					*errorPos = pos;
+				return false;
+			}
+		}
+		if( inArc )
+			oid.push_back( OIDValue(value) );
+		return true;
+	}
+	static bool parse(const StdString &text, OID &oid, Int64 *errorPos = nullptr)
+	{
+		return parse(text.data(), static_cast<Int64>(text.size()), oid, errorPos);
+	}
+
+private:
+	void parseOrThrow(const char *text, Int64 length)
+	{
+		Int64 errorPos = 0;
+		if( parse(text, length, *this, &errorPos) )
+			return;
+		StdString message = "Wrong OID \"" + StdString(text, static_cast<size_t>(length)) + "\" at position " + std::to_string(errorPos);
+		if( (text[errorPos] >= '0') && (text[errorPos] <= '9') )
+			throw std::out_of_range(message);
+		throw std::invalid_argument(message);
+	}
+
+public:
+
 	OID( const OIDValue &a )
 		: OID(1ll)
 	{
@@ -101,25 +175,31 @@ public:
 	{
 		if( oid.count() > count() )
 			return false;
-		for( int i = 0; i < oid.count(); ++i )
-			if( oid.at(i) != at(i) )
-				return false;
-		return true;
+		return !oid.count() || !memcmp( data(), oid.data(), static_cast<size_t>(oid.count()) * sizeof(OIDValue) );
 	}
 	bool endsWith(const OID &oid) const
 	{
 		if( oid.count() > count() )
 			return false;
-		for( int i = 1; i <= oid.count(); ++i )
-			if( oid.at(oid.count()-i) != at(count()-i) )
-				return false;
-		return true;
+		return !oid.count() || !memcmp( data() + (count() - oid.count()), oid.data(), static_cast<size_t>(oid.count()) * sizeof(OIDValue) );
+	}
+	bool operator==(const OID &oid) const	{ return (oid.count() == count()) && startsWith(oid);	}
+	bool operator!=(const OID &oid) const	{ return !operator==(oid);	}
+
+	// Appends the dotted text of this OID to out without temporaries.
+	void appendTo(StdString &out) const
+	{
+		for( OIDValue val : *this )
+		{
+			out.push_back('.');
+			val.appendTo(out);
+		}
 	}
 	StdString toStdString() const
 	{
 		StdString rtn;
-		for( OIDValue val : *this )
-			rtn += "." +  val.toStdString();
+		rtn.reserve( static_cast<StdString::size_type>(count()) * 4 );
+		appendTo(rtn);
 		return rtn;
 	}
 };
@@ -0,0 +1,194 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef OIDPREFIXTREE_H
+#define OIDPREFIXTREE_H
+
+#include <functional>
+#include <utility>
+
+#include "basic_types.h"
+#include "stdvector.h"
+#include "oid.h"
+#include "oidregistry.h"
+#include "pduvarbind.h"
+#include "messageview.h"
+
+namespace SNMP {
+
+/*
+ * Maps OID subtrees to values (usually handlers).
+ *
+ * The prefixes are kept in an OIDRegistry, so looking for the longest
+ * registered prefix of an OID is one hash lookup per arc, no matter how many
+ * prefixes are registered. Lookups works also over the BER bytes of the
+ * received varbinds, so the OID doesn't need to be decoded.
+ */
+template <typename T>
+class OIDPrefixTree
+{
+	typedef OIDRegistry::Handle Handle;
+
+	OIDRegistry mRegistry;
+	StdVector<Int64> mEntryIndex;	// Entry index of every registry handle or -1.
+	StdVector<std::pair<Handle, T>> mEntries;
+
+	Int64 entryIndex(Handle handle) const
+	{
+		return (handle < static_cast<UInt64>(mEntryIndex.count())) ? mEntryIndex[handle] : -1;
+	}
+
+public:
+	Int64 count() const		{ return mEntries.count();		}
+	bool isEmpty() const	{ return mEntries.isEmpty();	}
+	void clear()
+	{
+		mRegistry.clear();
+		mEntryIndex.clear();
+		mEntries.clear();
+	}
+
+	// Registers the subtree. If it was already registered, value is replaced.
+	void insert(const OID &prefix, const T &value)
+	{
+		Handle handle = mRegistry.intern(prefix);
+		if( handle >= static_cast<UInt64>(mEntryIndex.count()) )
+			mEntryIndex.resize( static_cast<Int64>(handle) + 1, -1 );
+
+		Int64 index = mEntryIndex[handle];
+		if( index == -1 )
+		{
+			mEntryIndex[handle] = mEntries.count();
+			mEntries.push_back( std::make_pair(handle, value) );
+		}
+		else
+			mEntries[index].second = value;
+	}
+	bool remove(const OID &prefix)
+	{
+		Handle handle = mRegistry.find(prefix);
+		Int64 index = (handle == OIDRegistry::InvalidHandle) ? -1 : entryIndex(handle);
+		if( index == -1 )
+			return false;
+
+		// Moves the last one to the removed place.
+		mEntryIndex[mEntries.back().first] = index;
+		mEntries[index] = std::move( mEntries.back() );
+		mEntries.pop_back();
+		mEntryIndex[handle] = -1;
+		return true;
+	}
+	// Returns the value registered exactly with this prefix or nullptr.
+	const T *value(const OID &prefix) const
+	{
+		Int64 index = entryIndex( mRegistry.find(prefix) );
+		return (index == -1) ? nullptr : &mEntries[index].second;
+	}
+
+	// Returns the value of the longest prefix of the oid or nullptr if none.
+	// prefixLength, if not null, gets the prefix length in arcs.
+	const T *longestMatch(const OID &oid, Int64 *prefixLength = nullptr) const
+	{
+		Int64 index = entryIndex(OIDRegistry::RootHandle);
+		Int64 length = 0;
+		Handle handle = OIDRegistry::RootHandle;
+		for( Int64 i = 0; i < oid.count(); ++i )
+		{
+			if( (handle = mRegistry.find(handle, oid[i].toULongLong())) == OIDRegistry::InvalidHandle )
+				break;
+			Int64 found = entryIndex(handle);
+			if( found != -1 )
+			{
+				index = found;
+				length = i + 1;
+			}
+		}
+		if( prefixLength )
+			*prefixLength = length;
+		return (index == -1) ? nullptr : &mEntries[index].second;
+	}
+	// Same as above but over the BER encoded OID.
+	const T *longestMatch(const Byte *berOID, Int64 length) const
+	{
+		Int64 index = entryIndex(OIDRegistry::RootHandle);
+		mRegistry.walk( berOID, length, [this, &index](Handle handle)
+		{
+			Int64 found = entryIndex(handle);
+			if( found != -1 )
+				index = found;
+		} );
+		return (index == -1) ? nullptr : &mEntries[index].second;
+	}
+	const T *longestMatch(const ByteView &berOID) const
+	{
+		return longestMatch(berOID.bytes(), berOID.count());
+	}
+};
+
+/*
+ * Routes varbinds to the handler registered for the longest prefix of their OID.
+ * Varbinds without handler are ignored. When dispatching a MessageView, only
+ * the varbinds with a handler are decoded.
+ */
+class VarbindDispatcher : public OIDPrefixTree<std::function<void(const PDUVarbind&)>>
+{
+public:
+	typedef std::function<void(const PDUVarbind&)> Handler;
+
+	// Returns true if there were a handler for the varbind.
+	bool dispatch(const PDUVarbind &varbind) const
+	{
+		const Handler *handler = longestMatch( varbind.oid() );
+		if( !handler )
+			return false;
+		(*handler)(varbind);
+		return true;
+	}
+	// Returns the count of varbinds dispatched.
+	// Stops at first varbind that cannot be decoded.
+	Int64 dispatch(const MessageView &message, bool includeRawData = false) const
+	{
+		Int64 count = 0;
+		ASN1Encoder::ErrorCode errorCode;
+		PDUVarbind varbind;
+		// Raw values point into the datagram, shared only if needed.
+		SharedDatagram datagram;
+		for( const MessageView::Varbind &raw : message )
+		{
+			const Handler *handler = longestMatch( raw.oidBytes() );
+			if( handler )
+			{
+				if( includeRawData && !datagram )
+					datagram = message.sharedDatagram();
+				if( !raw.decodeVarbind(errorCode, varbind, datagram) )
+					break;
+				(*handler)(varbind);
+				++count;
+			}
+		}
+		return count;
+	}
+};
+
+} // namespace SNMP
+
+#endif // OIDPREFIXTREE_H
@@ -0,0 +1,170 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#include "oidregistry.h"
+
+using namespace SNMP;
+
+const OIDRegistry::Handle OIDRegistry::InvalidHandle;
+const OIDRegistry::Handle OIDRegistry::RootHandle;
+
+void OIDRegistry::clear()
+{
+	mNodes.clear();
+	mSlots.clear();
+	Node root;
+	root.arc = 0;
+	root.parent = InvalidHandle;
+	root.depth = 0;
+	mNodes.push_back(root);
+	rehash(64);
+}
+
+void OIDRegistry::reserve(Int64 count)
+{
+	mNodes.reserve( static_cast<StdVector<Node>::size_type>(count) );
+	Int64 slotCount = mSlots.count();
+	while( slotCount < (count << 1) )
+		slotCount <<= 1;
+	if( slotCount != mSlots.count() )
+		rehash(slotCount);
+}
+
+// Returns the slot where the node is or -1 if not found.
+Int64 OIDRegistry::findSlot(Handle parent, UInt64 arc) const
+{
+	UInt64 mask = static_cast<UInt64>(mSlots.count() - 1);
+	UInt64 slot = hash(parent, arc) & mask;
+	Handle handle;
+	while( (handle = mSlots[static_cast<Int64>(slot)]) != InvalidHandle )
+	{
+		const Node &node = mNodes[handle];
+		if( (node.arc == arc) && (node.parent == parent) )
+			return static_cast<Int64>(slot);
+		slot = (slot + 1) & mask;
+	}
+	return -1;
+}
+
+void OIDRegistry::rehash(Int64 slotCount)
+{
+	mSlots.assign( static_cast<StdVector<Handle>::size_type>(slotCount), InvalidHandle );
+	UInt64 mask = static_cast<UInt64>(slotCount - 1);
+	for( Handle handle = 1; handle < static_cast<UInt64>(mNodes.count()); ++handle )
+	{
+		UInt64 slot = hash(mNodes[handle].parent, mNodes[handle].arc) & mask;
+		while( mSlots[static_cast<Int64>(slot)] != InvalidHandle )
+			slot = (slot + 1) & mask;
+		mSlots[static_cast<Int64>(slot)] = handle;
+	}
+}
+
+OIDRegistry::Handle OIDRegistry::intern(Handle parent, UInt64 arc)
+{
+	Int64 slot = findSlot(parent, arc);
+	if( slot != -1 )
+		return mSlots[slot];
+
+	// Keep the table half empty so probing stays short.
+	if( (mNodes.count() << 1) > mSlots.count() )
+		rehash( mSlots.count() << 1 );
+
+	Handle handle = static_cast<Handle>(mNodes.count());
+	Node node;
+	node.arc = arc;
+	node.parent = parent;
+	node.depth = mNodes[parent].depth + 1;
+	mNodes.push_back(node);
+
+	UInt64 mask = static_cast<UInt64>(mSlots.count() - 1);
+	UInt64 s = hash(parent, arc) & mask;
+	while( mSlots[static_cast<Int64>(s)] != InvalidHandle )
+		s = (s + 1) & mask;
+	mSlots[static_cast<Int64>(s)] = handle;
+	return handle;
+}
+
+OIDRegistry::Handle OIDRegistry::intern(const OID &oid)
+{
+	Handle handle = RootHandle;
+	for( OIDValue arc : oid )
+		handle = intern( handle, arc.toULongLong() );
+	return handle;
+}
+
+OIDRegistry::Handle OIDRegistry::intern(const CompactOID &oid)
+{
+	Handle handle = RootHandle;
+	for( CompactOID::Arc arc : oid )
+		handle = intern( handle, arc );
+	return handle;
+}
+
+OIDRegistry::Handle OIDRegistry::find(const OID &oid) const
+{
+	Handle handle = RootHandle;
+	for( Int64 i = 0; (i < oid.count()) && (handle != InvalidHandle); ++i )
+		handle = find( handle, oid[i].toULongLong() );
+	return handle;
+}
+
+OIDRegistry::Handle OIDRegistry::find(const CompactOID &oid) const
+{
+	Handle handle = RootHandle;
+	for( Int64 i = 0; (i < oid.count()) && (handle != InvalidHandle); ++i )
+		handle = find( handle, oid[i] );
+	return handle;
+}
+
+OID OIDRegistry::oid(Handle handle) const
+{
+	OID rtn( static_cast<Int64>(mNodes[handle].depth) );
+	for( Int64 i = mNodes[handle].depth - 1; i >= 0; --i )
+	{
+		rtn[i] = OIDValue( mNodes[handle].arc );
+		handle = mNodes[handle].parent;
+	}
+	return rtn;
+}
+
+void OIDRegistry::appendTo(Handle handle, StdString &out) const
+{
+	// Arcs are known from the last one to the first one.
+	Handle path[128];
+	Int64 count = 0;
+	Int64 depth = mNodes[handle].depth;
+	if( depth > 128 )
+	{
+		oid(handle).appendTo(out);
+		return;
+	}
+	while( handle != RootHandle )
+	{
+		path[count++] = handle;
+		handle = mNodes[handle].parent;
+	}
+	while( count-- > 0 )
+	{
+		out.push_back('.');
+		Utils::appendUnsigned( out, mNodes[path[count]].arc );
+	}
+}
@@ -0,0 +1,173 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef OIDREGISTRY_H
+#define OIDREGISTRY_H
+
+#include "basic_types.h"
+#include "stdvector.h"
+#include "stdstring.h"
+#include "byteview.h"
+#include "oid.h"
+#include "compactoid.h"
+
+namespace SNMP {
+
+/*
+ * Interns OIDs into 32 bits handles.
+ *
+ * Every OID is stored as a node with its last arc and the handle of its
+ * parent (the same OID without the last arc), so the registry is a tree
+ * kept in one vector. Interning an OID interns all its prefixes too.
+ * Handles are stable until clear() and two OIDs are equal only if their
+ * handles are equal, so handles can be compared and hashed directly.
+ *
+ * Children are found by a open addressing hash table on (parent, arc), so
+ * looking up an OID never allocates. This allows to resolve the OID bytes of
+ * a received varbind without decoding it into an OID object.
+ */
+class OIDRegistry
+{
+public:
+	typedef UInt32 Handle;
+	static const Handle InvalidHandle = 0xFFFFFFFF;
+	// The empty OID. Root of all the others.
+	static const Handle RootHandle = 0;
+
+private:
+	struct Node
+	{
+		UInt64 arc;
+		Handle parent;
+		UInt32 depth;
+	};
+	StdVector<Node> mNodes;
+	StdVector<Handle> mSlots;	// Hash table of the nodes but the root.
+
+	static UInt64 hash(Handle parent, UInt64 arc)
+	{
+		UInt64 h = (arc ^ (static_cast<UInt64>(parent) << 32)) * 0x9E3779B97F4A7C15ull;
+		return h ^ (h >> 29);
+	}
+	Int64 findSlot(Handle parent, UInt64 arc) const;
+	void rehash(Int64 slotCount);
+
+public:
+	OIDRegistry()
+	{
+		clear();
+	}
+	void clear();
+	void reserve(Int64 count);
+
+	// Number of handles, including the root.
+	Int64 count() const		{ return mNodes.count();	}
+	bool isValid(Handle handle) const	{ return handle < static_cast<UInt64>(mNodes.count());	}
+
+	// Returns the handle of the parent OID with the arc appended. Creates it if not exists.
+	Handle intern(Handle parent, UInt64 arc);
+	Handle intern(const OID &oid);
+	Handle intern(const CompactOID &oid);
+	Handle intern(const char *oid)		{ return intern( OID(oid) );	}
+	Handle intern(const StdString &oid)	{ return intern( OID(oid) );	}
+
+	// Functions returning InvalidHandle when the OID isn't registered.
+	// None of them allocates memory.
+	Handle find(Handle parent, UInt64 arc) const
+	{
+		Int64 slot = findSlot(parent, arc);
+		return (slot == -1) ? InvalidHandle : mSlots[slot];
+	}
+	Handle find(const OID &oid) const;
+	Handle find(const CompactOID &oid) const;
+	// Looks for the BER encoded OID (without type nor length bytes).
+	// Decodes the arcs like ASN1Encoder::decodeRawObjectIdentifier.
+	Handle find(const Byte *berOID, Int64 length) const
+	{
+		Handle handle = InvalidHandle;
+		return walk( berOID, length, [&handle](Handle h) { handle = h; } ) ? handle : InvalidHandle;
+	}
+	// Goes down the BER encoded OID calling visit(Handle) for every
+	// registered prefix, from the shortest to the longest.
+	// Returns true if the whole OID is registered.
+	template <typename Visitor>
+	bool walk(const Byte *berOID, Int64 length, Visitor visit) const
+	{
+		if( (length < 1) || (berOID[length-1] & 0x80) )
+			return false;
+
+		Handle handle = find( RootHandle, berOID[0] / 40 );
+		if( handle == InvalidHandle )
+			return false;
+		visit(handle);
+		if( (handle = find(handle, berOID[0] % 40)) == InvalidHandle )
+			return false;
+		visit(handle);
+
+		UInt64 value = 0;
+		for( Int64 pos = 1; pos < length; ++pos )
+		{
+			value = (value << 7) | (berOID[pos] & 0x7F);
+			if( !(berOID[pos] & 0x80) )
+			{
+				if( (handle = find(handle, value)) == InvalidHandle )
+					return false;
+				visit(handle);
+				value = 0;
+			}
+		}
+		return true;
+	}
+	Handle find(const ByteView &berOID) const	{ return find(berOID.bytes(), berOID.count());	}
+
+	Handle parent(Handle handle) const	{ return mNodes[handle].parent;	}
+	UInt64 lastArc(Handle handle) const	{ return mNodes[handle].arc;	}
+	Int64 depth(Handle handle) const	{ return mNodes[handle].depth;	}
+
+	// Returns the ancestor at depth or InvalidHandle if handle is shallower.
+	Handle ancestor(Handle handle, Int64 depth) const
+	{
+		if( depth > mNodes[handle].depth )
+			return InvalidHandle;
+		while( mNodes[handle].depth > depth )
+			handle = mNodes[handle].parent;
+		return handle;
+	}
+	// True if handle is base or any OID under it. Like OID::startsWith
+	bool startsWith(Handle handle, Handle base) const
+	{
+		return ancestor(handle, mNodes[base].depth) == base;
+	}
+
+	OID oid(Handle handle) const;
+	void appendTo(Handle handle, StdString &out) const;
+	StdString toStdString(Handle handle) const
+	{
+		StdString rtn;
+		appendTo(handle, rtn);
+		return rtn;
+	}
+};
+
+} // namespace SNMP
+
+#endif // OIDREGISTRY_H
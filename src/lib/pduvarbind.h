@@ -23,47 +23,55 @@
 #ifndef PDUVARBIND_H
 #define PDUVARBIND_H
 
+#include <utility>
+
 #include "stddeque.h"
 
 #include "asn1variable.h"
+#include "rawvalue.h"
 namespace SNMP {
 
 class PDUVarbind
 {
 	ASN1Variable mASN1Var;
-	StdByteVector mRawValue;
+	RawValue mRawValue;
 	OID mOID;
 
 public:
-	PDUVarbind( const OID &oid = OID(""), const SNMP::ASN1Variable &asn1Var = SNMP::ASN1Variable() )
-		: mASN1Var(asn1Var)
-		, mOID(oid)
+	// Arguments are taken by value so temporaries are moved in, not copied.
+	PDUVarbind( OID oid = OID(), SNMP::ASN1Variable asn1Var = SNMP::ASN1Variable() )
+		: mASN1Var(std::move(asn1Var))
+		, mOID(std::move(oid))
 	{
 
 	}
-	PDUVarbind( const PDUVarbind &varbind )
-		: mASN1Var(varbind.mASN1Var)
-		, mRawValue(varbind.mRawValue)
-		, mOID(varbind.mOID)
-	{
+	// All the varbind data will be taken from resource (an Arena, a pool...).
+	explicit PDUVarbind( MemoryResource *resource )
+		: mOID( Allocator<OIDValue>(resource) )
+	{	}
+	MemoryResource *resource() const	{ return mOID.get_allocator().resource();	}
 
-	}
 	void clear()
 	{
 		mASN1Var.clear();
 		mRawValue.clear();
 	}
-	const StdByteVector &rawValue() const			{ return mRawValue;	}
-	StdByteVector &rawValue()						{ return mRawValue;	}
-	void setRawValue(const StdByteVector &rawVal)	{ mRawValue = rawVal;	}
+	// View into the received datagram. See RawValue.
+	const RawValue &rawValue() const				{ return mRawValue;	}
+	RawValue &rawValue()							{ return mRawValue;	}
+	void setRawValue(const RawValue &rawVal)		{ mRawValue = rawVal;	}
+	void setRawValue(RawValue &&rawVal)				{ mRawValue = std::move(rawVal);	}
+	void setRawValue(const StdByteVector &rawVal)	{ mRawValue = RawValue(rawVal);	}
 
 	const OID &oid() const			{ return mOID;	}
 	OID &oid()						{ return mOID;	}
 	void setOID(const OID &oid)		{ mOID = oid;	}
+	void setOID(OID &&oid)			{ mOID = std::move(oid);	}
 
 	const ASN1Variable &asn1Variable() const			{ return mASN1Var;	}
 	ASN1Variable &asn1Variable()						{ return mASN1Var;	}
 	void setASN1Variable(const ASN1Variable &asn1Var)	{ mASN1Var = asn1Var;	}
+	void setASN1Variable(ASN1Variable &&asn1Var)		{ mASN1Var = std::move(asn1Var);	}
 };
 
 
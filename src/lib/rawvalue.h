@@ -0,0 +1,133 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef RAWVALUE_H
+#define RAWVALUE_H
+
+#include <memory>
+
+#include "basic_types.h"
+#include "allocator.h"
+#include "stdcharvector.h"
+#include "byteview.h"
+
+namespace SNMP {
+
+// Received datagram shared by everything decoded from it.
+typedef std::shared_ptr<const StdByteVector> SharedDatagram;
+
+// Copies the bytes into a new shared datagram taken from resource (the default one if null).
+inline SharedDatagram makeSharedDatagram(const Byte *bytes, Int64 count, MemoryResource *resource = nullptr)
+{
+	std::shared_ptr<StdByteVector> datagram = std::allocate_shared<StdByteVector>( Allocator<StdByteVector>(resource), Allocator<Byte>(resource) );
+	datagram->assign( bytes, bytes + count );
+	return datagram;
+}
+
+/*
+ * Raw bytes of a varbind value: offset and length into the received datagram.
+ *
+ * The datagram is shared by all the varbinds decoded from it and lives while
+ * any of them does, so keeping the raw values doesn't copy anything.
+ * Copies of values whose datagram is taken from another resource than the
+ * default one (an Arena, for example) get their own copy of the bytes.
+ */
+class RawValue
+{
+	SharedDatagram mDatagram;
+	Int64 mOffset;
+	Int64 mCount;
+
+	void copyFrom(const RawValue &other)
+	{
+		if( other.mDatagram && (other.mDatagram->get_allocator().resource() != defaultResource()) )
+		{
+			mDatagram = makeSharedDatagram( other.bytes(), other.mCount );
+			mOffset = 0;
+		}
+		else
+		{
+			mDatagram = other.mDatagram;
+			mOffset = other.mOffset;
+		}
+		mCount = other.mCount;
+	}
+
+public:
+	RawValue()
+		: mOffset(0)
+		, mCount(0)
+	{	}
+	RawValue(SharedDatagram datagram, Int64 offset, Int64 count)
+		: mDatagram(std::move(datagram))
+		, mOffset(offset)
+		, mCount(count)
+	{	}
+	// Keeps its own copy of bytes.
+	explicit RawValue(const StdByteVector &bytes)
+		: mDatagram( makeSharedDatagram(bytes.bytes(), bytes.count()) )
+		, mOffset(0)
+		, mCount(bytes.count())
+	{	}
+	RawValue(const RawValue &other)
+	{
+		copyFrom(other);
+	}
+	RawValue(RawValue &&other) = default;
+	RawValue &operator=(const RawValue &other)
+	{
+		if( this != &other )
+			copyFrom(other);
+		return *this;
+	}
+	RawValue &operator=(RawValue &&other) = default;
+
+	void clear()
+	{
+		mDatagram.reset();
+		mOffset = 0;
+		mCount = 0;
+	}
+	const SharedDatagram &datagram() const	{ return mDatagram;	}
+	Int64 offset() const		{ return mOffset;	}
+
+	const Byte *bytes() const	{ return mDatagram ? mDatagram->bytes() + mOffset : nullptr;	}
+	Int64 count() const			{ return mCount;	}
+	bool isEmpty() const		{ return mCount == 0;	}
+	// Same names as the containers, for the templates written for them.
+	const Byte *data() const	{ return bytes();	}
+	size_t size() const			{ return static_cast<size_t>(mCount);	}
+
+	Byte operator[](Int64 i) const	{ return bytes()[i];	}
+	const Byte *begin() const		{ return bytes();	}
+	const Byte *end() const			{ return bytes() + mCount;	}
+
+	ByteView view() const				{ return ByteView(bytes(), mCount);	}
+	StdByteVector toByteVector() const	{ return view().toByteVector();	}
+
+	bool operator==(const RawValue &other) const	{ return view() == other.view();	}
+	bool operator!=(const RawValue &other) const	{ return view() != other.view();	}
+};
+
+} // namespace SNMP
+
+#endif // RAWVALUE_H
@@ -0,0 +1,48 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#include "requesttemplate.h"
+
+using namespace SNMP;
+
+void RequestTemplate::setup(const Encoder &snmp)
+{
+	Int64 requestIDMark;
+	ASN1Writer sizer(nullptr, 0);
+	snmp.writeRequest(sizer, &requestIDMark);
+
+	mDatagram.resize( sizer.size() );
+	ASN1Writer writer(mDatagram.bytes(), mDatagram.count());
+	snmp.writeRequest(writer, &requestIDMark);
+
+	mRequestIDPos = mDatagram.count() - requestIDMark;
+}
+
+Int32 RequestTemplate::requestID() const
+{
+	assert( isValid() );
+	const Byte *bytes = mDatagram.bytes() + mRequestIDPos;
+	return static_cast<Int32>( (static_cast<UInt32>(bytes[0]) << 24) |
+							   (static_cast<UInt32>(bytes[1]) << 16) |
+							   (static_cast<UInt32>(bytes[2]) << 8) |
+							   static_cast<UInt32>(bytes[3]) );
+}
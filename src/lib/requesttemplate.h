@@ -0,0 +1,83 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef REQUESTTEMPLATE_H
+#define REQUESTTEMPLATE_H
+
+#include "stdcharvector.h"
+#include "snmpencoder.h"
+
+namespace SNMP {
+
+/*
+ * Pre-encoded request for the requests sent over and over again where only
+ * the request ID changes (polling the same OIDs, for example).
+ *
+ * The Encoder is encoded once. The request ID is encoded allways with 4 bytes
+ * so it can be changed in place without moving anything else in the datagram.
+ * Note that request IDs between -8388608 and 8388607 are encoded with leading
+ * 00 or FF bytes. Agents decode it fine, but it's not the shortest form.
+ */
+class RequestTemplate
+{
+	StdByteVector mDatagram;
+	Int64 mRequestIDPos;	// Position of the 4 bytes of the request ID value.
+
+public:
+	RequestTemplate()
+		: mRequestIDPos(-1)
+	{	}
+	explicit RequestTemplate(const Encoder &snmp)
+	{
+		setup(snmp);
+	}
+	void setup(const Encoder &snmp);
+
+	bool isValid() const	{ return mRequestIDPos != -1;	}
+
+	static void encodeRequestID(Int32 requestID, Byte *bytes)
+	{
+		UInt32 id = static_cast<UInt32>(requestID);
+		bytes[0] = static_cast<Byte>(id >> 24);
+		bytes[1] = static_cast<Byte>(id >> 16);
+		bytes[2] = static_cast<Byte>(id >> 8);
+		bytes[3] = static_cast<Byte>(id);
+	}
+	Int32 requestID() const;
+	void setRequestID(Int32 requestID)
+	{
+		assert( isValid() );
+		encodeRequestID( requestID, mDatagram.bytes() + mRequestIDPos );
+	}
+
+	const StdByteVector &datagram() const	{ return mDatagram;	}
+	// Sets the request ID and returns the datagram ready to be sent.
+	const StdByteVector &datagram(Int32 requestID)
+	{
+		setRequestID(requestID);
+		return mDatagram;
+	}
+};
+
+} // namespace SNMP
+
+#endif // REQUESTTEMPLATE_H
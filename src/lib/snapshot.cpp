@@ -0,0 +1,337 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#include "snapshot.h"
+
+using namespace SNMP;
+
+static const char SnapshotMagic[8] = { 'B', 'S', 'N', 'M', 'P', 'S', 'N', 'P' };
+static const UInt32 SnapshotByteOrder = 0x01020304;
+
+SnapshotBuilder::SnapshotBuilder(SnapshotKind kind, Int64 rowCount, Int64 keyCount, Int64 firstColumn, Int64 columnCount)
+	: mKind(kind)
+	, mRowCount(rowCount)
+	, mKeyCount(keyCount)
+	, mFirstColumn(firstColumn)
+{
+	if( kind == SnapshotKind::Table )
+		mKeys.resize( keyCount * rowCount, 0 );
+	else
+		mKeys.resize( rowCount + 1, 0 );
+
+	mColumns.resize(columnCount);
+	for( Column &column : mColumns )
+	{
+		column.values.resize( rowCount, 0 );
+		column.types.resize( rowCount, ASN1TYPE_NULL );
+		column.storage.resize( rowCount, SnapshotColumn::Number );
+		column.type = ASN1TYPE_NULL;
+	}
+	mStringOffsets.append(0);
+}
+
+UInt64 SnapshotBuilder::intern(const ByteView &bytes)
+{
+	UInt64 hash = TableValueIndex::hash(bytes);
+	auto range = mStringIds.equal_range(hash);
+	for( auto it = range.first; it != range.second; ++it )
+	{
+		Int64 id = static_cast<Int64>(it->second);
+		Int64 offset = static_cast<Int64>(mStringOffsets[id]);
+		if( ByteView(mStrings.data() + offset, static_cast<Int64>(mStringOffsets[id + 1]) - offset) == bytes )
+			return it->second;
+	}
+	UInt64 id = static_cast<UInt64>(mStringOffsets.count() - 1);
+	mStrings.insert( mStrings.end(), bytes.begin(), bytes.end() );
+	mStringOffsets.append( static_cast<UInt64>(mStrings.count()) );
+	mStringIds.emplace(hash, id);
+	return id;
+}
+
+void SnapshotBuilder::setBaseOID(const OID &base)
+{
+	mBase.clear();
+	for( const OIDValue &arc : base )
+		mBase.append( arc.toULongLong() );
+}
+
+void SnapshotBuilder::setOID(Int64 row, const OID &oid)
+{
+	for( const OIDValue &arc : oid )
+		mArcs.append( arc.toULongLong() );
+	mKeys[row + 1] = static_cast<UInt64>(mArcs.count());
+}
+
+void SnapshotBuilder::setCell(Int64 row, Int64 columnIndex, const ASN1Variable &value)
+{
+	Column &column = mColumns[columnIndex];
+	if( value.isNumberStorage() )
+	{
+		column.values[row] = value.toUInteger();
+		column.storage[row] = SnapshotColumn::Number;
+	}
+	else
+	{
+		column.values[row] = intern( value.storedBytes() );
+		column.storage[row] = SnapshotColumn::String;
+	}
+	column.types[row] = value.type();
+	if( (column.type == ASN1TYPE_NULL) && (value.type() != ASN1TYPE_NULL) )
+		column.type = value.type();
+}
+
+StdByteVector SnapshotBuilder::build() const
+{
+	UInt64 offset = sizeof(SnapshotHeader);
+	auto place = [&offset](UInt64 bytes) -> UInt64
+	{
+		UInt64 placed = offset;
+		offset += (bytes + 7) & ~UInt64(7);
+		return placed;
+	};
+	SnapshotHeader header;
+	memset( &header, 0, sizeof(header) );
+	memcpy( header.magic, SnapshotMagic, sizeof(header.magic) );
+	header.version = SnapshotView::Version;
+	header.byteOrder = SnapshotByteOrder;
+	header.kind = static_cast<UInt32>(mKind);
+	header.rowCount = static_cast<UInt64>(mRowCount);
+	header.keyCount = static_cast<UInt64>(mKeyCount);
+	header.columnCount = static_cast<UInt64>(mColumns.count());
+	header.firstColumn = mFirstColumn;
+	header.baseCount = static_cast<UInt64>(mBase.count());
+	header.baseOffset = place( header.baseCount * sizeof(UInt64) );
+	header.keysOffset = place( static_cast<UInt64>(mKeys.count()) * sizeof(UInt64) );
+	header.arcCount = static_cast<UInt64>(mArcs.count());
+	header.arcsOffset = place( header.arcCount * sizeof(UInt64) );
+	header.columnsOffset = place( header.columnCount * sizeof(SnapshotColumn) );
+
+	StdVector<SnapshotColumn> columns;
+	for( const Column &column : mColumns )
+	{
+		SnapshotColumn placed;
+		memset( &placed, 0, sizeof(placed) );
+		placed.valuesOffset = place( header.rowCount * sizeof(UInt64) );
+		placed.typesOffset = place( header.rowCount );
+		placed.storageOffset = place( header.rowCount );
+		placed.type = column.type;
+		columns.append(placed);
+	}
+	header.stringCount = static_cast<UInt64>(mStringOffsets.count() - 1);
+	header.stringsOffset = place( static_cast<UInt64>(mStringOffsets.count()) * sizeof(UInt64) );
+	header.stringBytes = static_cast<UInt64>(mStrings.count());
+	header.stringBytesOffset = place( header.stringBytes );
+	header.size = offset;
+
+	StdByteVector snapshot( static_cast<Int64>(header.size) );
+	Byte *data = snapshot.data();
+	auto write = [data](UInt64 at, const void *bytes, UInt64 count)
+	{
+		if( count )
+			memcpy( data + at, bytes, static_cast<size_t>(count) );
+	};
+	write( 0, &header, sizeof(header) );
+	write( header.baseOffset, mBase.data(), header.baseCount * sizeof(UInt64) );
+	write( header.keysOffset, mKeys.data(), static_cast<UInt64>(mKeys.count()) * sizeof(UInt64) );
+	write( header.arcsOffset, mArcs.data(), header.arcCount * sizeof(UInt64) );
+	write( header.columnsOffset, columns.data(), header.columnCount * sizeof(SnapshotColumn) );
+	for( Int64 i = 0; i < mColumns.count(); ++i )
+	{
+		write( columns[i].valuesOffset, mColumns[i].values.data(), header.rowCount * sizeof(UInt64) );
+		write( columns[i].typesOffset, mColumns[i].types.data(), header.rowCount );
+		write( columns[i].storageOffset, mColumns[i].storage.data(), header.rowCount );
+	}
+	write( header.stringsOffset, mStringOffsets.data(), static_cast<UInt64>(mStringOffsets.count()) * sizeof(UInt64) );
+	write( header.stringBytesOffset, mStrings.data(), header.stringBytes );
+	return snapshot;
+}
+
+bool SnapshotView::load(const Byte *data, Int64 size)
+{
+	mData = nullptr;
+	mHeader = nullptr;
+	if( !data || (size < static_cast<Int64>(sizeof(SnapshotHeader))) || (reinterpret_cast<uintptr_t>(data) & 7) )
+		return false;
+
+	const SnapshotHeader *header = reinterpret_cast<const SnapshotHeader*>(data);
+	if( memcmp(header->magic, SnapshotMagic, sizeof(header->magic)) || (header->version != Version) ||
+		(header->byteOrder != SnapshotByteOrder) || (header->size > static_cast<UInt64>(size)) )
+		return false;
+
+	// Counts are checked against the size first, so the sizes below don't overflow.
+	const UInt64 total = header->size;
+	if( (header->rowCount > total) || (header->keyCount > total) || (header->columnCount > total) ||
+		(header->baseCount > total) || (header->arcCount > total) || (header->stringCount > total) )
+		return false;
+	auto fits = [total](UInt64 offset, UInt64 count, UInt64 elementSize)
+	{
+		return !(offset & 7) && (offset <= total) && (count <= (total - offset) / elementSize);
+	};
+	switch( static_cast<SnapshotKind>(header->kind) )
+	{
+	case SnapshotKind::Table:
+		if( header->keyCount && (header->rowCount > total / sizeof(UInt64) / header->keyCount) )
+			return false;
+		if( !fits(header->keysOffset, header->keyCount * header->rowCount, sizeof(UInt64)) )
+			return false;
+		break;
+	case SnapshotKind::VarbindList:
+		if( header->keyCount || (header->columnCount != 1) ||
+			!fits(header->keysOffset, header->rowCount + 1, sizeof(UInt64)) ||
+			!fits(header->arcsOffset, header->arcCount, sizeof(UInt64)) )
+			return false;
+		break;
+	default:
+		return false;
+	}
+	if( !fits(header->baseOffset, header->baseCount, sizeof(UInt64)) ||
+		!fits(header->columnsOffset, header->columnCount, sizeof(SnapshotColumn)) ||
+		!fits(header->stringsOffset, header->stringCount + 1, sizeof(UInt64)) ||
+		!fits(header->stringBytesOffset, header->stringBytes, 1) )
+		return false;
+
+	const SnapshotColumn *columns = reinterpret_cast<const SnapshotColumn*>(data + header->columnsOffset);
+	for( UInt64 i = 0; i < header->columnCount; ++i )
+	{
+		if( !fits(columns[i].valuesOffset, header->rowCount, sizeof(UInt64)) ||
+			!fits(columns[i].typesOffset, header->rowCount, 1) ||
+			!fits(columns[i].storageOffset, header->rowCount, 1) )
+			return false;
+	}
+	mData = data;
+	mHeader = header;
+	return true;
+}
+
+OID SnapshotView::baseOID() const
+{
+	OID oid;
+	const UInt64 *arcs = array<UInt64>(mHeader->baseOffset);
+	oid.reserve( static_cast<Int64>(mHeader->baseCount) );
+	for( UInt64 i = 0; i < mHeader->baseCount; ++i )
+		oid.append( OIDValue(arcs[i]) );
+	return oid;
+}
+
+OID SnapshotView::keys(Int64 row) const
+{
+	OID keys;
+	keys.reserve( keyCount() );
+	for( Int64 k = 0; k < keyCount(); ++k )
+		keys.append( OIDValue(key(row, k)) );
+	return keys;
+}
+
+Int64 SnapshotView::findRow(const OID &keys) const
+{
+	if( keys.count() != keyCount() )
+		return -1;
+	Int64 first = 0;
+	Int64 last = rowCount();
+	while( first < last )
+	{
+		Int64 middle = first + (last - first) / 2;
+		int compare = 0;
+		for( Int64 k = 0; !compare && (k < keyCount()); ++k )
+		{
+			UInt64 rowKey = key(middle, k);
+			UInt64 wanted = keys[k].toULongLong();
+			if( rowKey != wanted )
+				compare = (rowKey < wanted) ? -1 : 1;
+		}
+		if( !compare )
+			return middle;
+		if( compare < 0 )
+			first = middle + 1;
+		else
+			last = middle;
+	}
+	return -1;
+}
+
+OID SnapshotView::oid(Int64 row) const
+{
+	OID oid;
+	const UInt64 *offsets = array<UInt64>(mHeader->keysOffset);
+	UInt64 first = offsets[row];
+	UInt64 last = offsets[row + 1];
+	if( (first > last) || (last > mHeader->arcCount) )
+		return oid;
+
+	const UInt64 *arcs = array<UInt64>(mHeader->arcsOffset);
+	oid.reserve( static_cast<Int64>(last - first) );
+	for( UInt64 i = first; i < last; ++i )
+		oid.append( OIDValue(arcs[i]) );
+	return oid;
+}
+
+PDUVarbindList SnapshotView::varbindList() const
+{
+	PDUVarbindList list;
+	for( Int64 row = 0; row < rowCount(); ++row )
+		list.append( varbind(row) );
+	return list;
+}
+
+ByteView SnapshotView::string(UInt64 id) const
+{
+	if( id >= mHeader->stringCount )
+		return ByteView();
+	const UInt64 *offsets = array<UInt64>(mHeader->stringsOffset);
+	UInt64 first = offsets[id];
+	UInt64 last = offsets[id + 1];
+	if( (first > last) || (last > mHeader->stringBytes) )
+		return ByteView();
+	return ByteView( mData + mHeader->stringBytesOffset + first, static_cast<Int64>(last - first) );
+}
+
+ASN1Variable SnapshotView::cell(Int64 row, Int64 columnIndex) const
+{
+	const SnapshotColumn &column = columnHeader(columnIndex);
+	ASN1DataType type = array<Byte>(column.typesOffset)[row];
+	UInt64 value = array<UInt64>(column.valuesOffset)[row];
+	ASN1Variable cell;
+	if( array<Byte>(column.storageOffset)[row] == SnapshotColumn::String )
+	{
+		ByteView bytes = string(value);
+		cell.setData( type, bytes.bytes(), bytes.count() );
+	}
+	else
+	{
+		cell.setUInteger(value);
+		cell.setType(type);
+	}
+	return cell;
+}
+
+StdByteVector SNMP::varbindListSnapshot(const PDUVarbindList &varbinds)
+{
+	SnapshotBuilder builder( SnapshotKind::VarbindList, static_cast<Int64>(varbinds.size()), 0, 0, 1 );
+	Int64 row = 0;
+	for( const PDUVarbind &varbind : varbinds )
+	{
+		builder.setOID( row, varbind.oid() );
+		builder.setCell( row, 0, varbind.asn1Variable() );
+		++row;
+	}
+	return builder.build();
+}
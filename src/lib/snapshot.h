@@ -0,0 +1,214 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "snmptable.h"
+
+#include <unordered_map>
+
+namespace SNMP {
+
+/*
+ * Binary snapshots of tables and varbind lists, to get them back on
+ * startup without walking the agents again.
+ *
+ * The file is a header followed by 8 bytes aligned arrays, all in host
+ * byte order: table rows sorted by keys with an array of key values per
+ * key position (varbind lists have an OID per row instead), an array of
+ * values per column (numbers or interned string ids) with its types, and
+ * the interned strings. So, a SnapshotView reads it right from memory,
+ * as a mapped file (QFile::map, mmap), checking the header and the arrays
+ * bounds only: cells are read when asked for.
+ */
+enum class SnapshotKind : UInt32
+{
+	Table = 1,
+	VarbindList = 2
+};
+
+struct SnapshotHeader
+{
+	char magic[8];
+	UInt32 version;
+	UInt32 byteOrder;
+	UInt32 kind;
+	UInt32 reserved;
+	UInt64 size;
+	UInt64 rowCount;
+	UInt64 keyCount;		// Keys per row. 0 for varbind lists.
+	UInt64 columnCount;
+	Int64 firstColumn;
+	UInt64 baseOffset;		// Table base OID arcs.
+	UInt64 baseCount;
+	UInt64 keysOffset;		// Table: keyCount arrays of rowCount keys. Varbind list: rowCount+1 OID offsets in the arcs.
+	UInt64 arcsOffset;		// Varbind list OID arcs.
+	UInt64 arcCount;
+	UInt64 columnsOffset;	// columnCount SnapshotColumn.
+	UInt64 stringsOffset;	// stringCount+1 offsets in the string bytes.
+	UInt64 stringCount;
+	UInt64 stringBytesOffset;
+	UInt64 stringBytes;
+};
+
+struct SnapshotColumn
+{
+	UInt64 valuesOffset;	// rowCount UInt64: the number or the string id.
+	UInt64 typesOffset;		// rowCount ASN1DataType.
+	UInt64 storageOffset;	// rowCount bytes: Number or String.
+	UInt32 type;			// Type of the first not null cell.
+	UInt32 reserved;
+
+	enum Storage : Byte
+	{
+		Number,
+		String
+	};
+};
+
+// Collects rows and cells and lays them out in a snapshot.
+class SnapshotBuilder
+{
+	struct Column
+	{
+		StdVector<UInt64> values;
+		StdVector<Byte> types;
+		StdVector<Byte> storage;
+		ASN1DataType type;
+	};
+	SnapshotKind mKind;
+	Int64 mRowCount;
+	Int64 mKeyCount;
+	Int64 mFirstColumn;
+	StdVector<UInt64> mBase;
+	StdVector<UInt64> mKeys;
+	StdVector<UInt64> mArcs;
+	StdVector<Column> mColumns;
+	StdVector<UInt64> mStringOffsets;
+	StdVector<Byte> mStrings;
+	std::unordered_multimap<UInt64, UInt64> mStringIds;	// String hash -> id.
+
+	UInt64 intern(const ByteView &bytes);
+
+public:
+	// Varbind lists have a column and no keys; rows are added by setOID().
+	SnapshotBuilder(SnapshotKind kind, Int64 rowCount, Int64 keyCount, Int64 firstColumn, Int64 columnCount);
+
+	void setBaseOID(const OID &base);
+	void setKey(Int64 row, Int64 keyIndex, UInt64 key)	{ mKeys[keyIndex * mRowCount + row] = key;	}
+	// Varbind lists only. Rows must be given in order.
+	void setOID(Int64 row, const OID &oid);
+	void setCell(Int64 row, Int64 columnIndex, const ASN1Variable &value);
+
+	StdByteVector build() const;
+};
+
+// Reads a snapshot from memory, that must outlive the view.
+class SnapshotView
+{
+	const Byte *mData;
+	const SnapshotHeader *mHeader;
+
+	template <typename U>
+	const U *array(UInt64 offset) const	{ return reinterpret_cast<const U*>(mData + offset);	}
+	const SnapshotColumn &columnHeader(Int64 columnIndex) const	{ return array<SnapshotColumn>(mHeader->columnsOffset)[columnIndex];	}
+
+public:
+	static const UInt32 Version = 1;
+
+	SnapshotView()
+		: mData(nullptr)
+		, mHeader(nullptr)
+	{	}
+	// Checks the header and that every array fits in size. Data must be 8 bytes aligned.
+	bool load(const Byte *data, Int64 size);
+	bool isValid() const	{ return mHeader != nullptr;	}
+
+	SnapshotKind kind() const		{ return static_cast<SnapshotKind>(mHeader->kind);	}
+	Int64 rowCount() const			{ return static_cast<Int64>(mHeader->rowCount);	}
+	Int64 keyCount() const			{ return static_cast<Int64>(mHeader->keyCount);	}
+	Int64 columnCount() const		{ return static_cast<Int64>(mHeader->columnCount);	}
+	Int64 firstColumn() const		{ return mHeader->firstColumn;	}
+	OID baseOID() const;
+
+	// Tables.
+	UInt64 key(Int64 row, Int64 keyIndex) const	{ return array<UInt64>(mHeader->keysOffset)[keyIndex * rowCount() + row];	}
+	OID keys(Int64 row) const;
+	// Row with the keys, by a binary search, or -1 if none.
+	Int64 findRow(const OID &keys) const;
+
+	// Varbind lists.
+	OID oid(Int64 row) const;
+	PDUVarbind varbind(Int64 row) const		{ return PDUVarbind( oid(row), cell(row, 0) );	}
+	PDUVarbindList varbindList() const;
+
+	// Column values. Strings are given by its ids.
+	const UInt64 *values(Int64 columnIndex) const		{ return array<UInt64>(columnHeader(columnIndex).valuesOffset);	}
+	ASN1DataType columnType(Int64 columnIndex) const	{ return static_cast<ASN1DataType>(columnHeader(columnIndex).type);	}
+	ASN1DataType cellType(Int64 row, Int64 columnIndex) const	{ return array<Byte>(columnHeader(columnIndex).typesOffset)[row];	}
+	// Bytes of a string id. Empty if the id is out of range.
+	ByteView string(UInt64 id) const;
+	ASN1Variable cell(Int64 row, Int64 columnIndex) const;
+};
+
+template <class T>
+StdByteVector tableSnapshot(const TableBase<T> &table)
+{
+	const StdVector<Int64> &rows = table.orderedRows();
+	SnapshotBuilder builder( SnapshotKind::Table, rows.count(), table.keyCount(), table.firstColumn(), table.columnCount() );
+
+	builder.setBaseOID( table.oidBase() );
+	for( Int64 i = 0; i < rows.count(); ++i )
+	{
+		const T &row = table.at( rows[i] );
+		for( Int64 k = 0; k < table.keyCount(); ++k )
+			builder.setKey( i, k, row.key(k).toULongLong() );
+		for( Int64 c = 0; c < table.columnCount(); ++c )
+			builder.setCell( i, c, row.cell(table.firstColumn() + c) );
+	}
+	return builder.build();
+}
+StdByteVector varbindListSnapshot(const PDUVarbindList &varbinds);
+
+// Adds the snapshot rows to the table, or updates them, as setCellData does.
+// Fails if the snapshot is not of a table like this one.
+template <class T>
+bool restoreTable(const SnapshotView &snapshot, TableBase<T> &table)
+{
+	if( !snapshot.isValid() || (snapshot.kind() != SnapshotKind::Table) ||
+		(snapshot.keyCount() != table.keyCount()) || (snapshot.firstColumn() != table.firstColumn()) ||
+		(snapshot.columnCount() != table.columnCount()) || (snapshot.baseOID() != table.oidBase()) )
+		return false;
+
+	for( Int64 i = 0; i < snapshot.rowCount(); ++i )
+	{
+		Int64 row = table.insertRow( snapshot.keys(i) );
+		for( Int64 c = 0; c < snapshot.columnCount(); ++c )
+			table.setCell( row, table.firstColumn() + c, snapshot.cell(i, c) );
+	}
+	return true;
+}
+
+}	// namespace SNMP
+
+#endif // SNAPSHOT_H
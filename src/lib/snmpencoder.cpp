@@ -21,6 +21,8 @@
 **************************************************************************/
 
 #include "snmpencoder.h"
+#include "requesttemplate.h"
+#include "messageview.h"
 
 using namespace SNMP;
 
@@ -38,15 +40,20 @@ void Encoder::addPDUVar(const PDUVarbind &pduVarbind)
 	mVarbindList.append(pduVarbind);
 }
 
+void Encoder::addPDUVar(PDUVarbind &&pduVarbind)
+{
+	mVarbindList.append(std::move(pduVarbind));
+}
+
 void Encoder::addCellPDUVar(OID oidBase, const OID &keyValues, OIDValue oidColumn, const ASN1Variable &asn1Var )
 {
 	oidBase.push_back(oidColumn);
 	for( auto k : keyValues )
 		oidBase.push_back(k);
-	addPDUVar( PDUVarbind(oidBase, asn1Var) );
+	emplacePDUVar( std::move(oidBase), asn1Var );
 }
 
-void Encoder::setupRequest(int version, const StdString &comunity, int requestID, ASN1DataType requestCode, const PDUVarbindList &varbindList)
+void Encoder::setupHeader(int version, const StdString &comunity, int requestID, ASN1DataType requestCode)
 {
 	assert( (requestCode == ASN1TYPE_GetRequestPDU) || (requestCode == ASN1TYPE_GetNextRequestPDU) || (requestCode == ASN1TYPE_SetRequestPDU));
 
@@ -56,17 +63,26 @@ void Encoder::setupRequest(int version, const StdString &comunity, int requestID
 	mErrorCode = ASN1Encoder::ErrorCode::NoError;
 	mErrorObjectIndex = 0;
 	mRequestType = requestCode;
+}
+
+void Encoder::setupRequest(int version, const StdString &comunity, int requestID, ASN1DataType requestCode, const PDUVarbindList &varbindList)
+{
+	setupHeader(version, comunity, requestID, requestCode);
 	mVarbindList = varbindList;
 }
 
+void Encoder::setupRequest(int version, const StdString &comunity, int requestID, ASN1DataType requestCode, PDUVarbindList &&varbindList)
+{
+	setupHeader(version, comunity, requestID, requestCode);
+	mVarbindList = std::move(varbindList);
+}
+
 void Encoder::setupRequest(int version, const StdString &comunity, int requestID, ASN1DataType requestCode, const OIDList &oidList)
 {
+	setupHeader(version, comunity, requestID, requestCode);
 	mVarbindList.clear();
-
 	for( const OID &oid : oidList )
-		mVarbindList.append( PDUVarbind(oid, ASN1Variable()) );
-
-	return setupRequest( version, comunity, requestID, requestCode, mVarbindList );
+		mVarbindList.emplace(oid);
 }
 
 void Encoder::setupGetRequest(int version, const StdString &comunity, int requestID, const OID &oid)
@@ -94,90 +110,150 @@ void Encoder::setupSetRequest(int version, const StdString &comunity, int reques
 	return setupRequest(version, comunity, requestID, ASN1TYPE_SetRequestPDU, varbindList);
 }
 
+void Encoder::setupSetRequest(int version, const StdString &comunity, int requestID, PDUVarbindList &&varbindList)
+{
+	return setupRequest(version, comunity, requestID, ASN1TYPE_SetRequestPDU, std::move(varbindList));
+}
+
 void Encoder::setupSetRequest(int version, const StdString &comunity, int requestID, const OID &oid, const ASN1Variable &asn1Var)
 {
-	return setupSetRequest(version, comunity, requestID, PDUVarbindList() << PDUVarbind(oid, asn1Var) );
+	setupHeader(version, comunity, requestID, ASN1TYPE_SetRequestPDU);
+	mVarbindList.clear();
+	mVarbindList.emplace(oid, asn1Var);
 }
 
 bool Encoder::decodeAll(const StdByteVector &ba, bool includeRawData)
 {
-	ASN1Variable asn1Var;
-	Int64 pos = 0;
-	Int64 length;
-
-	mErrorCode = ASN1Encoder::ErrorCode::NoError;
-	mErrorObjectIndex = 0;
-	if( !ASN1Encoder::decodeSequence(mErrorCode, ba, pos, length) )
-		return false;
-	if( !ASN1Encoder::decodeInteger(mErrorCode, mVersion, ba, pos, true) )
-		return false;
-
-	// Comunity.
-	StdByteVector comunity;
-	if( !ASN1Encoder::decodeOctetString(mErrorCode, comunity, ba, pos) )
-		return false;
-	setComunity(comunity);
-
-	if( !ASN1Encoder::decodePDURequest(mErrorCode, ba, pos) )
-		return false;
+	return decodeAll( MessageView(ba), includeRawData );
+}
 
-	// Request ID.
-	if( !ASN1Encoder::decodeInteger(mErrorCode, mRequestID, ba, pos, true) )
-		return false;
+bool Encoder::decodeAll(const StdByteVector &ba, bool includeRawData, MemoryResource &resource)
+{
+	return decodeAll( MessageView(ba), includeRawData, &resource );
+}
 
-	// Error code.
-	int errorCode;
-	// TODO: Shall splitout decoding error code and remote error code?
-	if( !ASN1Encoder::decodeInteger(mErrorCode, errorCode, ba, pos, false) )
+bool Encoder::decodeAll(const MessageView &message, bool includeRawData, MemoryResource *resource)
+{
+	mErrorObjectIndex = 0;
+	if( !message.isValid() )
+	{
+		// Nothing of a previously decoded message must be left, as this object may be reused.
+		mVersion = 0;
+		mComunity.clear();
+		mRequestType = 0;
+		mRequestID = 0;
+		mVarbindList.clear();
+		mErrorCode = message.errorCode();
 		return false;
-	mErrorCode = static_cast<ASN1Encoder::ErrorCode>(errorCode);
-
-	// Error index.
-	if( !ASN1Encoder::decodeInteger(mErrorCode, mErrorObjectIndex, ba, pos, false) )
+	}
+	mVersion = message.version();
+	mComunity.assign( message.comunity().chars(), static_cast<StdString::size_type>(message.comunity().count()) );
+	mRequestType = message.requestType();
+	mRequestID = message.requestID();
+	mErrorObjectIndex = message.errorObjectIndex();
+
+	// Every varbind is decoded in place, so nothing is copied. The varbinds
+	// already in the list are overwritten: their OIDs and values keep their
+	// storage, so decoding same shaped messages again doesn't allocate.
+	// A list using another resource is swapped out: swapping lists doesn't allocate
+	// and the old list is destroyed with the temporary.
+	if( !resource )
+		resource = defaultResource();
+	if( mVarbindList.get_allocator().resource() != resource )
+		PDUVarbindList( Allocator<PDUVarbind>(resource) ).swap(mVarbindList);
+	// Raw values are just views into the datagram, shared by all the varbinds.
+	SharedDatagram datagram;
+	if( includeRawData && message.varbindCount() )
+		datagram = message.sharedDatagram(resource);
+	Int64 count = 0;
+	bool ok = true;
+	for( const MessageView::Varbind &varbind : message )
+	{
+		PDUVarbind &pduVar = (count < mVarbindList.count()) ? mVarbindList.at(count) : mVarbindList.emplace(resource);
+		if( !varbind.decodeVarbind(mErrorCode, pduVar, datagram) )
+		{
+			ok = false;
+			break;
+		}
+		++count;
+	}
+	// Drops the varbinds left from a bigger message and the one failed.
+	mVarbindList.erase( mVarbindList.begin() + count, mVarbindList.end() );
+	if( !ok )
 		return false;
+	mErrorCode = message.errorStatus();
+	return mErrorCode == ASN1Encoder::ErrorCode::NoError;
+}
 
-	Int64 varbindListLength;
-	if( !ASN1Encoder::decodeSequence(mErrorCode, ba, pos, varbindListLength) )
-		return false;
+// Writes the whole request backwards. See ASN1Writer.
+// If requestIDMark is not null, request ID is written allways with 4 bytes and
+// requestIDMark is set to its writer mark (bytes from the end to the value).
+void Encoder::writeRequest(ASN1Writer &writer, Int64 *requestIDMark) const
+{
+	Int64 messageMark = writer.mark();
+	Int64 pduMark = writer.mark();
+	Int64 varbindListMark = writer.mark();
 
-	// And the variable list.
-	PDUVarbind pduVar;
-	mVarbindList.clear();
-	while( pos < ba.count() )
+	for( auto it = mVarbindList.rbegin(); it != mVarbindList.rend(); ++it )
 	{
-		Int64 varbindLength;
-		if( !ASN1Encoder::decodeSequence(mErrorCode, ba, pos, varbindLength) )
-			return false;
-		if( !ASN1Encoder::decodeObjectIdentifier(mErrorCode, pduVar.oid(), ba, pos) )
-			return false;
-		if( !ASN1Encoder::decodeUnknown(mErrorCode, ba, pos, pduVar.asn1Variable(), includeRawData ? &pduVar.rawValue() : nullptr) )
-			return false;
-		mVarbindList.append(pduVar);
+		Int64 varbindMark = writer.mark();
+		writer.writeUnknown( it->asn1Variable() );
+		writer.writeObjectIdentifier( it->oid() );
+		writer.writeSequence( varbindMark );
 	}
-
-	// Now, pos shall point to the next data.
-
-	return mErrorCode == ASN1Encoder::ErrorCode::NoError;
+	writer.writeSequence( varbindListMark );						// Varbind List
+	writer.writeInteger( 0, ASN1TYPE_INTEGER, true );				// Error Index
+	writer.writeInteger( 0, ASN1TYPE_INTEGER, true );				// Error Code
+	if( requestIDMark == nullptr )
+		writer.writeInteger( mRequestID, ASN1TYPE_INTEGER, false );	// RequestID
+	else
+	{
+		Byte bytes[4];
+		RequestTemplate::encodeRequestID( mRequestID, bytes );
+		writer.writeBytes( bytes, 4 );
+		*requestIDMark = writer.mark();
+		writer.writeHeader( ASN1TYPE_INTEGER, 4 );
+	}
+	writer.writeList( mRequestType, pduMark );
+	writer.writeOctetString( mComunity );
+	writer.writeInteger( mVersion, ASN1TYPE_INTEGER, true );
+	writer.writeSequence( messageMark );
 }
 
 StdByteVector Encoder::encodeRequest() const
 {
-	StdByteVector varbindEncoded;
-	StdByteVectorList v;
+	// First pass, without buffer, just to know the size.
+	ASN1Writer sizer(nullptr, 0);
+	writeRequest(sizer);
+
+	StdByteVector ba(sizer.size());
+	ASN1Writer writer(ba.bytes(), ba.count());
+	writeRequest(writer);
+	return ba;
+}
 
-	for( const PDUVarbind &varbind : mVarbindList )
+bool Encoder::encodeRequestInto(Byte *buffer, Int64 capacity, Int64 &size) const
+{
+	ASN1Writer writer(buffer, capacity);
+	writeRequest(writer);
+	size = writer.size();
+	if( writer.overflow() )
+		return false;
+
+	// Writer fills the buffer from the end.
+	if( size < capacity )
+		memmove( buffer, writer.data(), static_cast<size_t>(size) );
+	return true;
+}
+
+void Encoder::encodeRequestInto(StdByteVector &ba) const
+{
+	Int64 size;
+	ba.resize( static_cast<Int64>(ba.capacity()) );
+	if( !encodeRequestInto(ba.bytes(), ba.count(), size) )
 	{
-		varbindEncoded += ASN1Encoder::encodeSequence(StdByteVectorList()
-													 << ASN1Encoder::encodeObjectIdentifier(varbind.oid())
-													 << ASN1Encoder::encodeUnknown(varbind.asn1Variable()) );
+		ba.resize( size );
+		encodeRequestInto(ba.bytes(), ba.count(), size);
 	}
-	return ASN1Encoder::encodeSequence( StdByteVectorList()
-										<< ASN1Encoder::encodeInteger(mVersion, ASN1TYPE_INTEGER, true)
-										<< ASN1Encoder::encodeOctetString(mComunity)
-										<< ASN1Encoder::encodeList(mRequestType,
-																  StdByteVectorList()
-																	<< ASN1Encoder::encodeInteger(mRequestID, ASN1TYPE_INTEGER, false)	// RequestID
-																	<< ASN1Encoder::encodeInteger(0, ASN1TYPE_INTEGER, true)	// Error Code
-																	<< ASN1Encoder::encodeInteger(0, ASN1TYPE_INTEGER, true)	// Error Index
-																	<< ASN1Encoder::encodeSequence(StdByteVectorList() << varbindEncoded) ) );	// Varbind List
+	ba.resize( size );
 }
@@ -26,11 +26,14 @@
 #include "asn1variable.h"
 #include "asn1types.h"
 #include "asn1encoder.h"
+#include "asn1writer.h"
 
 #include "pduvarbind.h"
 
 namespace SNMP {
 
+class MessageView;
+
 class Encoder
 {
 	Int32 mVersion;
@@ -41,6 +44,10 @@ class Encoder
 	ASN1DataType mRequestType;
 	PDUVarbindList mVarbindList;
 
+	void writeRequest(ASN1Writer &writer, Int64 *requestIDMark = nullptr) const;
+	void setupHeader(int version, const StdString &comunity, int requestID, ASN1DataType requestCode);
+	friend class RequestTemplate;
+
 public:
 	Encoder();
 
@@ -49,6 +56,7 @@ public:
 
 	const StdString &comunity() const		{ return mComunity;	}
 	void setComunity(const StdString &c)	{ mComunity = c;	}
+	void setComunity(StdString &&c)			{ mComunity = std::move(c);	}
 	void setComunity(const StdByteVector &c){ mComunity = c.toStdString(); }
 
 	void setComunity(const char *c)			{ mComunity = StdString(c);	}
@@ -66,12 +74,20 @@ public:
 	void setRequestType(ASN1DataType requestType)	{ mRequestType = requestType;	}
 
 	void addPDUVar(const PDUVarbind &pduVarbind);
+	void addPDUVar(PDUVarbind &&pduVarbind);
+	// Constructs the varbind in place. Arguments are the PDUVarbind constructor ones.
+	template <typename... Args>
+	PDUVarbind &emplacePDUVar(Args&&... args)
+	{
+		return mVarbindList.emplace(std::forward<Args>(args)...);
+	}
 	void addCellPDUVar(OID oidBase, const OID &keyValues, OIDValue oidColumn, const ASN1Variable &asn1Var);
 
 	const PDUVarbindList &varbindList()	const	{ return mVarbindList;	}
 	void setObjectIdentifier(const OID &oid)	{ addPDUVar(oid);	}
 
 	void setupRequest(int version, const StdString &comunity, int requestID, ASN1DataType requestCode, const PDUVarbindList &varbindList);
+	void setupRequest(int version, const StdString &comunity, int requestID, ASN1DataType requestCode, PDUVarbindList &&varbindList);
 	void setupRequest(int version, const StdString &comunity, int requestID, ASN1DataType requestCode, const OIDList &oidList);
 	void setupGetRequest(int version, const StdString &comunity, int requestID, const OID &oid);
 	void setupGetRequest(int version, const StdString &comunity, int requestID, const OIDList &oidList);
@@ -79,12 +95,36 @@ public:
 	void setupGetNextRequest(int version, const StdString &comunity, int requestID, const OIDList &oidList);
 
 	void setupSetRequest(int version, const StdString &comunity, int requestID, const PDUVarbindList &varbindList);
+	void setupSetRequest(int version, const StdString &comunity, int requestID, PDUVarbindList &&varbindList);
 	void setupSetRequest(int version, const StdString &comunity, int requestID, const OID &oid, const ASN1Variable &asn1Var);
 
 	void setError(ASN1Encoder::ErrorCode code, int index)	{ mErrorCode = code; mErrorObjectIndex = index;}
 
+	// Decodes in two phases: the whole datagram structure is validated once
+	// (see MessageView) and then values are read without any more bounds checks.
+	// Reusing the same Encoder for every datagram recycles the varbinds storage.
 	bool decodeAll(const StdByteVector &ba, bool includeRawData);
+	// Same as above, but all the varbinds data is taken from resource.
+	// With an Arena, the varbind list is valid until the arena is reset. Call
+	// clearVarbindList() or destroy this object before resetting the arena.
+	bool decodeAll(const StdByteVector &ba, bool includeRawData, MemoryResource &resource);
+	// Decodes a message already validated, so the datagram is not parsed twice.
+	bool decodeAll(const MessageView &message, bool includeRawData, MemoryResource *resource = nullptr);
+	void clearVarbindList()	{ PDUVarbindList().swap(mVarbindList);	}
+	// Releases the datagram the raw values point to, so it can be reused.
+	void clearRawValues()
+	{
+		for( PDUVarbind &varbind : mVarbindList )
+			varbind.rawValue().clear();
+	}
 	StdByteVector encodeRequest() const;
+	// Encodes the request into the caller buffer, starting at buffer[0].
+	// size is set to the datagram size. Returns false if it's bigger than capacity;
+	// in that case, size is the capacity required and the buffer content is garbage.
+	bool encodeRequestInto(Byte *buffer, Int64 capacity, Int64 &size) const;
+	// Encodes the request into ba reusing its capacity. Once ba is big enough,
+	// no allocation is done.
+	void encodeRequestInto(StdByteVector &ba) const;
 };
 
 } // namespace SNMP
@@ -31,17 +31,31 @@ namespace SNMP {
 	};
 }
 #include "types.h"
+#include "allocator.h"
+#include "arena.h"
 #include "../utils.h"
 #include "stdcharvector.h"
+#include "byteview.h"
 #include "stdlist.h"
 #include "stddeque.h"
 #include "asn1types.h"
+#include "asn1typetable.h"
 #include "oid.h"
+#include "compactoid.h"
+#include "oidregistry.h"
 #include "asn1variable.h"
 #include "asn1encoder.h"
+#include "asn1writer.h"
 #include "pduvarbind.h"
+#include "rawvalue.h"
+#include "textwriter.h"
 #include "snmpencoder.h"
+#include "requesttemplate.h"
+#include "messageview.h"
+#include "oidprefixtree.h"
 #include "snmptable.h"
+#include "columntable.h"
+#include "snapshot.h"
 
 
 #endif // QSNMPLIB_H
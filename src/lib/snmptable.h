@@ -25,12 +25,18 @@
 
 #include "oid.h"
 #include "snmpencoder.h"
+#include "messageview.h"
 #include "pduvarbind.h"
 #include "stddeque.h"
 
 #include <random>
 #include <ctime>
 #include <iostream>
+#include <type_traits>
+#include <map>
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
 
 namespace SNMP {
 
@@ -93,19 +99,46 @@ struct TableInfo
 	{
 		interpret(baseOID, snmp);
 	}
+	TableInfo(const OID &baseOID, const MessageView &message)
+	{
+		interpret(baseOID, message);
+	}
 	void interpret(const OID &baseOID, const Encoder &snmp)
 	{
 		if( snmp.varbindList().count() )
-		{
-			varbind = snmp.varbindList().first();
-			column = varbind.oid()[baseOID.count()].toULongLong();
+			interpret(baseOID, snmp.varbindList().first());
+	}
+	// Only the first varbind is decoded.
+	void interpret(const OID &baseOID, const MessageView &message)
+	{
+		if( message.varbindCount() )
+			interpret(baseOID, *message.varbinds().begin());
+	}
+	void interpret(const OID &baseOID, const PDUVarbind &firstVarbind)
+	{
+		varbind = firstVarbind;
+		column = varbind.oid()[baseOID.count()].toULongLong();
 
-			for( Int64 i = baseOID.count()+1; i < varbind.oid().count(); ++i )
-				keyIndexes.push_back( varbind.oid()[i] );
-		}
+		for( Int64 i = baseOID.count()+1; i < varbind.oid().count(); ++i )
+			keyIndexes.push_back( varbind.oid()[i] );
 	}
 };
 
+// What TableBase::ingest() did with a varbind.
+struct IngestOutcome
+{
+	enum Result : Byte
+	{
+		Updated,	// Stored in an existing row.
+		Added,		// Stored in a new row.
+		NotInTable,	// The OID is not of the table.
+		BadColumn,	// The column is out of the table ones.
+		BadKeys		// The OID has not the table key count.
+	};
+	Result result;
+	Int64 row;		// -1 if not stored.
+};
+
 template <typename T>
 class TableBaseInfo
 {
@@ -142,11 +175,16 @@ class TableRowBase : public TableBaseInfo<T>
 	OID mKeys;
 
 public:
-	TableRowBase( int dataId )
+	// Cells and keys are taken from resource, the default one if null.
+	TableRowBase( int dataId, MemoryResource *resource = nullptr )
 		: TableBaseInfo<T> (dataId)
-		, mCells( TableRowBase::columnCount() )
-		, mKeys( TableRowBase::keyCount() )
-	{	}
+		, mCells( Allocator<ASN1Variable>(resource) )
+		, mKeys( Allocator<OIDValue>(resource) )
+	{
+		mCells.resize( TableRowBase::columnCount() );
+		mKeys.resize( TableRowBase::keyCount() );
+	}
+	MemoryResource *resource() const	{ return mCells.get_allocator().resource();	}
 
 	Int64 columnToIndex(Int64 column) const		{ return column - TableRowBase::firstColumn();	}
 	Int64 indexToColumn(Int64 index) const		{ return index + TableRowBase::firstColumn();	}
@@ -173,6 +211,8 @@ public:
 
 	const ASN1Variable &cell(Int64 col) const	{ return mCells.at( columnToIndex(col) ); }
 	ASN1Variable &cell(Int64 col)				{ return mCells.at( columnToIndex(col) ); }
+	// Copies the value keeping it in the row resource.
+	void setCell(Int64 col, const ASN1Variable &value)	{ cell(col).assign( value, resource() );	}
 
 	PDUVarbind varbind(Int64 col) const		{ return PDUVarbind( cellOID(col), cell(col) ); }
 	PDUVarbindList varbindList(Int64 rowStatusCol) const
@@ -200,23 +240,709 @@ public:
 	}
 };
 
+/*
+ * Index of the table rows by a cell or key value. Only hashes are stored:
+ * callers check the values of the rows found. Integer values are also kept
+ * as intervals of used ones so a free value is found in O(log n).
+ */
+class TableValueIndex
+{
+	typedef std::unordered_multimap<UInt64, Int64> RowMap;
+	RowMap mRows;						// Value hash -> row.
+	std::map<Int64, Int64> mIntegers;	// Used integers as [first, last] intervals.
+	bool mEnabled;
+
+	void useInteger(Int64 value)
+	{
+		auto next = mIntegers.upper_bound(value);
+		if( next != mIntegers.begin() )
+		{
+			auto prev = std::prev(next);
+			if( value <= prev->second )
+				return;
+			if( prev->second == value - 1 )
+			{
+				prev->second = value;
+				if( (next != mIntegers.end()) && (next->first == value + 1) )
+				{
+					prev->second = next->second;
+					mIntegers.erase(next);
+				}
+				return;
+			}
+		}
+		if( (next != mIntegers.end()) && (next->first == value + 1) )
+		{
+			Int64 last = next->second;
+			mIntegers.erase(next);
+			mIntegers.emplace(value, last);
+		}
+		else
+			mIntegers.emplace(value, value);
+	}
+	void releaseInteger(Int64 value)
+	{
+		auto it = mIntegers.upper_bound(value);
+		if( it == mIntegers.begin() )
+			return;
+		--it;
+		Int64 first = it->first;
+		Int64 last = it->second;
+		if( value > last )
+			return;
+		mIntegers.erase(it);
+		if( first < value )
+			mIntegers.emplace(first, value - 1);
+		if( value < last )
+			mIntegers.emplace(value + 1, last);
+	}
+
+public:
+	TableValueIndex()
+		: mEnabled(false)
+	{	}
+	bool isEnabled() const			{ return mEnabled;	}
+	void setEnabled(bool enabled)	{ mEnabled = enabled;	}
+
+	static UInt64 hash(const ByteView &bytes)
+	{
+		// FNV-1a
+		UInt64 h = 0xCBF29CE484222325ull;
+		for( Byte b : bytes )
+			h = (h ^ b) * 0x100000001B3ull;
+		return h;
+	}
+
+	void clear()
+	{
+		mRows.clear();
+		mIntegers.clear();
+	}
+	void insert(UInt64 hash, Int64 row)	{ mRows.emplace(hash, row);	}
+	void insertInteger(Int64 value, Int64 row)
+	{
+		insert( static_cast<UInt64>(value), row );
+		useInteger(value);
+	}
+	void remove(UInt64 hash, Int64 row)
+	{
+		auto range = mRows.equal_range(hash);
+		for( auto it = range.first; it != range.second; ++it )
+		{
+			if( it->second == row )
+			{
+				mRows.erase(it);
+				break;
+			}
+		}
+	}
+	// The integer stays used while other rows have it.
+	void removeInteger(Int64 value, Int64 row)
+	{
+		remove( static_cast<UInt64>(value), row );
+		if( !mRows.count(static_cast<UInt64>(value)) )
+			releaseInteger(value);
+	}
+	// Next rows move one position up, as removing a row from the table does.
+	void rowRemoved(Int64 row)
+	{
+		for( auto &entry : mRows )
+			if( entry.second > row )
+				--entry.second;
+	}
+	// Rows move to its newRows position. Removed ones must be removed before.
+	void renumber(const StdVector<Int64> &newRows)
+	{
+		for( auto &entry : mRows )
+			entry.second = newRows[entry.second];
+	}
+	// Lowest row with hash for which matches(row) is true or -1 if none.
+	template <typename Matches>
+	Int64 find(UInt64 hash, Matches matches) const
+	{
+		Int64 found = -1;
+		auto range = mRows.equal_range(hash);
+		for( auto it = range.first; it != range.second; ++it )
+			if( ((found == -1) || (it->second < found)) && matches(it->second) )
+				found = it->second;
+		return found;
+	}
+	// Lowest integer, not less than from, that no row has.
+	Int64 freeInteger(Int64 from) const
+	{
+		auto it = mIntegers.upper_bound(from);
+		if( it != mIntegers.begin() )
+		{
+			--it;
+			if( from <= it->second )
+				return it->second + 1;
+		}
+		return from;
+	}
+};
+
+/*
+ * Hash index of the table rows by its keys, so rows are found in O(1).
+ * Only hashes are stored: callers check the keys of the rows found.
+ * There is also an index per key position for the rows having a key value.
+ */
+class TableKeyIndex
+{
+	typedef std::unordered_multimap<UInt64, Int64> RowMap;
+	RowMap mRows;						// Keys hash -> row.
+	StdVector<TableValueIndex> mKeyRows;	// Key value -> row, for every key position.
+
+public:
+	static UInt64 hash(const OIDValue *keys, Int64 count)
+	{
+		UInt64 h = static_cast<UInt64>(count);
+		for( Int64 i = 0; i < count; ++i )
+		{
+			h = (h ^ keys[i].toULongLong()) * 0x9E3779B97F4A7C15ull;
+			h ^= h >> 29;
+		}
+		return h;
+	}
+
+	void clear(Int64 keyCount)
+	{
+		mRows.clear();
+		mKeyRows.clear();
+		mKeyRows.resize(keyCount);
+	}
+	void insert(const OID &keys, Int64 row)
+	{
+		mRows.emplace( hash(keys.data(), keys.count()), row );
+		for( Int64 k = 0; (k < keys.count()) && (k < mKeyRows.count()); ++k )
+			mKeyRows[k].insertInteger( static_cast<Int64>(keys[k].toULongLong()), row );
+	}
+	// Removes the row, leaving the next ones as they are. See renumber().
+	void unindex(const OID &keys, Int64 row)
+	{
+		UInt64 keysHash = hash(keys.data(), keys.count());
+		auto range = mRows.equal_range(keysHash);
+		for( auto it = range.first; it != range.second; ++it )
+		{
+			if( it->second == row )
+			{
+				mRows.erase(it);
+				break;
+			}
+		}
+		for( Int64 k = 0; (k < keys.count()) && (k < mKeyRows.count()); ++k )
+			mKeyRows[k].removeInteger( static_cast<Int64>(keys[k].toULongLong()), row );
+	}
+	// Removes the row and moves up the next ones, as removing it from the table does.
+	void remove(const OID &keys, Int64 row)
+	{
+		unindex(keys, row);
+		for( auto &entry : mRows )
+			if( entry.second > row )
+				--entry.second;
+		for( TableValueIndex &keyRows : mKeyRows )
+			keyRows.rowRemoved(row);
+	}
+	// Rows move to its newRows position. Removed ones must be unindexed before.
+	void renumber(const StdVector<Int64> &newRows)
+	{
+		for( auto &entry : mRows )
+			entry.second = newRows[entry.second];
+		for( TableValueIndex &keyRows : mKeyRows )
+			keyRows.renumber(newRows);
+	}
+	template <typename Matches>
+	Int64 find(UInt64 keysHash, Matches matches) const
+	{
+		Int64 found = -1;
+		auto range = mRows.equal_range(keysHash);
+		for( auto it = range.first; it != range.second; ++it )
+			if( ((found == -1) || (it->second < found)) && matches(it->second) )
+				found = it->second;
+		return found;
+	}
+	// Lowest row with the key value at keyIndex position.
+	Int64 keyRow(Int64 keyIndex, UInt64 keyValue) const
+	{
+		return mKeyRows[keyIndex].find( keyValue, [](Int64) { return true; } );
+	}
+	// Lowest key value, not less than from, that no row has at keyIndex position.
+	UInt64 freeKey(Int64 keyIndex, UInt64 from) const
+	{
+		return static_cast<UInt64>( mKeyRows[keyIndex].freeInteger(static_cast<Int64>(from)) );
+	}
+};
+
+/*
+ * Table rows in key order, the one GetNext walks them. Rows are kept
+ * sorted by its keys; new ones wait in a buffer that is sorted and merged
+ * in on the next ordered query, so filling a table doesn't sort it again
+ * and again. Keys are read through keyAt(row, keyIndex) -> UInt64.
+ */
+class TableKeyOrder
+{
+	StdVector<Int64> mSorted;
+	StdVector<Int64> mPending;
+
+	// Compares the row keys with keys: <0, 0 or >0. Only count keys are compared.
+	template <typename KeyAt>
+	static int compare(KeyAt keyAt, Int64 row, const OIDValue *keys, Int64 count)
+	{
+		for( Int64 k = 0; k < count; ++k )
+		{
+			UInt64 key = keyAt(row, k);
+			if( key != keys[k].toULongLong() )
+				return (key < keys[k].toULongLong()) ? -1 : 1;
+		}
+		return 0;
+	}
+
+public:
+	void clear()
+	{
+		mSorted.clear();
+		mPending.clear();
+	}
+	void insert(Int64 row)	{ mPending.append(row);	}
+	// The row keys changed, so it's sorted again on the next ordered query.
+	void update(Int64 row)
+	{
+		mSorted.erase( std::remove(mSorted.begin(), mSorted.end(), row), mSorted.end() );
+		if( std::find(mPending.begin(), mPending.end(), row) == mPending.end() )
+			mPending.append(row);
+	}
+	// Removes the row and moves up the next ones, as removing it from the table does.
+	void remove(Int64 row)
+	{
+		for( StdVector<Int64> *rows : { &mSorted, &mPending } )
+		{
+			rows->erase( std::remove(rows->begin(), rows->end(), row), rows->end() );
+			for( Int64 &r : *rows )
+				if( r > row )
+					--r;
+		}
+	}
+	// Rows move to its newRows position; the ones with -1 are removed.
+	// Renumbering keeps the order, so nothing is sorted again.
+	void renumber(const StdVector<Int64> &newRows)
+	{
+		for( StdVector<Int64> *rows : { &mSorted, &mPending } )
+		{
+			Int64 kept = 0;
+			for( Int64 r : *rows )
+				if( newRows[r] != -1 )
+					(*rows)[kept++] = newRows[r];
+			rows->resize(kept);
+		}
+	}
+
+	// Rows sorted by its keys.
+	template <typename KeyAt>
+	const StdVector<Int64> &rows(Int64 keyCount, KeyAt keyAt)
+	{
+		if( !mPending.isEmpty() )
+		{
+			auto less = [keyCount, keyAt](Int64 a, Int64 b)
+			{
+				for( Int64 k = 0; k < keyCount; ++k )
+				{
+					UInt64 keyA = keyAt(a, k);
+					UInt64 keyB = keyAt(b, k);
+					if( keyA != keyB )
+						return keyA < keyB;
+				}
+				return a < b;
+			};
+			std::sort( mPending.begin(), mPending.end(), less );
+			Int64 middle = mSorted.count();
+			mSorted.append( mPending );
+			mPending.clear();
+			std::inplace_merge( mSorted.begin(), mSorted.begin() + middle, mSorted.end(), less );
+		}
+		return mSorted;
+	}
+	// First position, in rows(), whose row keys are not less than keys.
+	// A partial keys is less than the keys it is the beginning of.
+	template <typename KeyAt>
+	Int64 lowerBound(Int64 keyCount, KeyAt keyAt, const OID &keys)
+	{
+		const StdVector<Int64> &sorted = rows(keyCount, keyAt);
+		Int64 count = std::min(keyCount, keys.count());
+		auto it = std::lower_bound( sorted.begin(), sorted.end(), 0, [&](Int64 row, int)
+		{
+			int c = compare(keyAt, row, keys.data(), count);
+			return (c < 0) || ((c == 0) && (keyCount < keys.count()));
+		});
+		return static_cast<Int64>(it - sorted.begin());
+	}
+	// First position, in rows(), whose row keys are greater than keys.
+	// That's the GetNext row, if keys is a row OID suffix.
+	template <typename KeyAt>
+	Int64 upperBound(Int64 keyCount, KeyAt keyAt, const OID &keys)
+	{
+		const StdVector<Int64> &sorted = rows(keyCount, keyAt);
+		Int64 count = std::min(keyCount, keys.count());
+		auto it = std::upper_bound( sorted.begin(), sorted.end(), 0, [&](int, Int64 row)
+		{
+			int c = compare(keyAt, row, keys.data(), count);
+			return (c > 0) || ((c == 0) && (keyCount > keys.count()));
+		});
+		return static_cast<Int64>(it - sorted.begin());
+	}
+	// Positions [first, second), in rows(), of the rows whose keys begins with prefix.
+	template <typename KeyAt>
+	std::pair<Int64, Int64> prefixRange(Int64 keyCount, KeyAt keyAt, const OID &prefix)
+	{
+		Int64 first = lowerBound(keyCount, keyAt, prefix);
+		if( prefix.count() > keyCount )
+			return std::make_pair(first, first);
+
+		const StdVector<Int64> &sorted = rows(keyCount, keyAt);
+		auto it = std::upper_bound( sorted.begin() + first, sorted.end(), 0, [&](int, Int64 row)
+		{
+			return compare(keyAt, row, prefix.data(), prefix.count()) > 0;
+		});
+		return std::make_pair( first, static_cast<Int64>(it - sorted.begin()) );
+	}
+};
+
+// Changes of a table since a generation (see TableBase::changesSince).
+struct TableChanges
+{
+	StdVector<Int64> addedRows;
+	StdVector<OID> removedKeys;		// Keys of the rows removed.
+	StdVector<std::pair<Int64, Int64>> changedCells;	// Row and column of the cells changed in the other rows.
+
+	bool isEmpty() const	{ return addedRows.isEmpty() && removedKeys.isEmpty() && changedCells.isEmpty();	}
+};
+
+/*
+ * Generation counters of the table rows and cells. Every change takes the
+ * next generation, so the changes since a generation are the rows and
+ * cells with a greater one. Removed rows are logged with its keys until
+ * forgotten. Rows also record the last generation they were seen in, for
+ * mark and sweep refreshes.
+ */
+class TableVersions
+{
+	struct RemovedRow
+	{
+		UInt64 generation;
+		UInt64 added;
+		OID keys;
+	};
+	UInt64 mGeneration;
+	Int64 mColumnCount;
+	StdVector<UInt64> mAdded;	// Per row.
+	StdVector<UInt64> mChanged;	// Per row, the last cell change.
+	StdVector<UInt64> mSeen;	// Per row.
+	StdVector<UInt64> mCells;	// Per row and column.
+	StdDeque<RemovedRow> mRemoved;
+
+public:
+	TableVersions(Int64 columnCount)
+		: mGeneration(0)
+		, mColumnCount(columnCount)
+	{	}
+
+	UInt64 generation() const	{ return mGeneration;	}
+	UInt64 nextGeneration()		{ return ++mGeneration;	}
+	Int64 count() const			{ return mAdded.count();	}
+
+	void addRow()
+	{
+		UInt64 generation = nextGeneration();
+		mAdded.append(generation);
+		mChanged.append(generation);
+		mSeen.append(generation);
+		mCells.resize( mCells.count() + mColumnCount, generation );
+	}
+	void changeCell(Int64 row, Int64 columnIndex)
+	{
+		UInt64 generation = nextGeneration();
+		mCells[row * mColumnCount + columnIndex] = generation;
+		mChanged[row] = generation;
+		mSeen[row] = generation;
+	}
+	void seeRow(Int64 row)		{ mSeen[row] = mGeneration;	}
+	// Next rows move one position up, as removing it from the table does.
+	void removeRow(Int64 row, const OID &keys)
+	{
+		mRemoved.push_back( RemovedRow{ nextGeneration(), mAdded[row], keys } );
+		mAdded.erase( mAdded.begin() + row );
+		mChanged.erase( mChanged.begin() + row );
+		mSeen.erase( mSeen.begin() + row );
+		mCells.erase( mCells.begin() + row * mColumnCount, mCells.begin() + (row + 1) * mColumnCount );
+	}
+	// The row keys changed: the old ones are logged as removed and the row
+	// is taken as added now, so it's reported as both.
+	void rekeyRow(Int64 row, const OID &oldKeys)
+	{
+		mRemoved.push_back( RemovedRow{ nextGeneration(), mAdded[row], oldKeys } );
+		UInt64 generation = nextGeneration();
+		mAdded[row] = generation;
+		mChanged[row] = generation;
+		mSeen[row] = generation;
+		std::fill( mCells.begin() + row * mColumnCount, mCells.begin() + (row + 1) * mColumnCount, generation );
+	}
+	// Removes, in a single pass, the rows with -1 in newRows and moves the
+	// others up. All of them are logged with the same generation, with the
+	// keys given by keysOf(row).
+	template <typename KeysOf>
+	void removeRows(const StdVector<Int64> &newRows, KeysOf keysOf)
+	{
+		UInt64 generation = nextGeneration();
+		Int64 kept = 0;
+		for( Int64 row = 0; row < count(); ++row )
+		{
+			if( newRows[row] == -1 )
+			{
+				mRemoved.push_back( RemovedRow{ generation, mAdded[row], keysOf(row) } );
+				continue;
+			}
+			if( kept != row )
+			{
+				mAdded[kept] = mAdded[row];
+				mChanged[kept] = mChanged[row];
+				mSeen[kept] = mSeen[row];
+				std::copy( mCells.begin() + row * mColumnCount, mCells.begin() + (row + 1) * mColumnCount, mCells.begin() + kept * mColumnCount );
+			}
+			++kept;
+		}
+		resize(kept);
+	}
+	// Rows not added through addRow() are taken as added now; removed ones, from the end.
+	void resize(Int64 rows)
+	{
+		while( count() < rows )
+			addRow();
+		if( count() > rows )
+		{
+			mAdded.resize(rows);
+			mChanged.resize(rows);
+			mSeen.resize(rows);
+			mCells.resize(rows * mColumnCount);
+		}
+	}
+	// Removed rows logged up to generation are not reported anymore.
+	void forgetRemoved(UInt64 generation)
+	{
+		while( !mRemoved.empty() && (mRemoved.front().generation <= generation) )
+			mRemoved.pop_front();
+	}
+
+	UInt64 seen(Int64 row) const	{ return mSeen[row];	}
+
+	TableChanges changesSince(UInt64 generation, Int64 firstColumn) const
+	{
+		TableChanges changes;
+		for( Int64 row = 0; row < count(); ++row )
+		{
+			if( mAdded[row] > generation )
+				changes.addedRows.append(row);
+			else
+			if( mChanged[row] > generation )
+			{
+				for( Int64 i = 0; i < mColumnCount; ++i )
+					if( mCells[row * mColumnCount + i] > generation )
+						changes.changedCells.append( std::make_pair(row, firstColumn + i) );
+			}
+		}
+		for( const RemovedRow &removed : mRemoved )
+			if( (removed.generation > generation) && (removed.added <= generation) )
+				changes.removedKeys.append(removed.keys);
+		return changes;
+	}
+};
+
+/*
+ * Rows, cells and keys are taken from the table resource. So, long lived
+ * tables may live in its own pool while the decoding scratch is taken from
+ * an Arena. Rows must be constructible from (dataId, MemoryResource*) to
+ * store its cells in the table resource; otherwise, they use the default one.
+ *
+ * Rows are indexed by its keys (see TableKeyIndex) and kept in key order
+ * (see TableKeyOrder). Columns can be indexed too, calling indexColumn().
+ * Changes done through setCellData(), ingest(), setKey() and removeRow() are
+ * tracked by generations (see TableVersions and changesSince()).
+ *
+ * Keys must be changed through setKey() and cells through setCell(), so
+ * indexes are kept up to date. Rows added or removed directly on the deque
+ * are noticed by the row count only: after changing keys or indexed cells
+ * directly, or removing and adding the same count of rows, call
+ * invalidateIndexes() (rebuilt on the next lookup) or reindex() (now).
+ *
+ * Lookups are const, but they rebuild stale indexes and sort the rows added
+ * since the last ordered query. So, they are not safe for concurrent readers
+ * unless updateIndexes() is called before sharing the table: until it
+ * changes again, lookups write nothing.
+ */
 template <class T>
 class TableBase : public StdDeque<T>, public TableBaseInfo<T>
 {
+	typedef std::is_constructible<T, int, MemoryResource*> RowTakesResource;
+
+	// Rows index by keys. Rebuilt if rows were added or removed directly on the deque
+	// or invalidateIndexes() was called (mIndexedCount is -1 then).
+	mutable TableKeyIndex mIndex;
+	mutable StdVector<TableValueIndex> mColumnIndexes;
+	mutable TableKeyOrder mOrder;
+	mutable TableVersions mVersions;
+	mutable Int64 mIndexedCount;
+	UInt64 mRefreshGeneration;
+
+	void appendRow(std::true_type)	{ TableBase::emplace( TableBase::dataId(), resource() );	}
+	void appendRow(std::false_type)	{ TableBase::emplace( TableBase::dataId() );	}
+
+	// Appends a row with the keys found in oid from firstKey on. Indexes must be in sync.
+	Int64 newRow(const OID &oid, Int64 firstKey)
+	{
+		Int64 row = TableBase::count();
+		appendRow( RowTakesResource() );
+
+		// Copy the keys.
+		for( int key= 0; key < TableBase::keyCount(); ++key )
+			TableBase::last().key(key) = oid.at( firstKey + key );
+		mIndex.insert( TableBase::last().keys(), row );
+		mOrder.insert(row);
+		mVersions.addRow();
+		mIndexedCount = TableBase::count();
+		return row;
+	}
+	void storeCell(Int64 row, Int64 col, const ASN1Variable &value)
+	{
+		if( TableBase::at(row).cell(col) == value )
+		{
+			mVersions.seeRow(row);
+			return;
+		}
+		mVersions.changeCell( row, col - TableBase::firstColumn() );
+		if( isColumnIndexed(col) )
+		{
+			TableValueIndex &columnIndex = mColumnIndexes[col - TableBase::firstColumn()];
+			unindexCell( columnIndex, TableBase::at(row).cell(col), row );
+			TableBase::at(row).setCell( col, value );
+			indexCell( columnIndex, TableBase::at(row).cell(col), row );
+		}
+		else
+			TableBase::at(row).setCell( col, value );
+	}
+
+	const TableKeyIndex &index() const
+	{
+		if( mIndexedCount != TableBase::count() )
+			reindex();
+		return mIndex;
+	}
+	UInt64 keyAt(Int64 row, Int64 keyIndex) const	{ return TableBase::at(row).key(keyIndex).toULongLong();	}
+	TableKeyOrder &order() const
+	{
+		index();
+		return mOrder;
+	}
+	// Column index or null if the column is not indexed.
+	const TableValueIndex *columnIndex(Int64 column) const
+	{
+		Int64 i = column - TableBase::firstColumn();
+		if( (i < 0) || (i >= mColumnIndexes.count()) || !mColumnIndexes[i].isEnabled() )
+			return nullptr;
+		index();
+		return &mColumnIndexes[i];
+	}
+	static bool isIntegerCell(const ASN1Variable &cell)
+	{
+		ASN1ValueKind kind = ASN1Encoder::ValueKinds[cell.type()];
+		return (kind == ASN1ValueKind::Number) || (kind == ASN1ValueKind::IPv4Address);
+	}
+	// Null cells are not set yet, so they are left out.
+	static void indexCell(TableValueIndex &columnIndex, const ASN1Variable &cell, Int64 row)
+	{
+		if( isIntegerCell(cell) )
+			columnIndex.insertInteger( cell.toInteger(), row );
+		else
+		if( cell.type() != ASN1TYPE_NULL )
+			columnIndex.insert( TableValueIndex::hash(cell.octetStringView()), row );
+	}
+	static void unindexCell(TableValueIndex &columnIndex, const ASN1Variable &cell, Int64 row)
+	{
+		if( isIntegerCell(cell) )
+			columnIndex.removeInteger( cell.toInteger(), row );
+		else
+		if( cell.type() != ASN1TYPE_NULL )
+			columnIndex.remove( TableValueIndex::hash(cell.octetStringView()), row );
+	}
 
 public:
-	TableBase(int dataId)
-		: TableBaseInfo<T>(dataId)
+	TableBase(int dataId, MemoryResource *resource = nullptr)
+		: StdDeque<T>( Allocator<T>(resource) )
+		, TableBaseInfo<T>(dataId)
+		, mVersions( TableBaseInfo<T>::columnCount() )
+		, mIndexedCount(-1)
+		, mRefreshGeneration(0)
 	{	}
+	MemoryResource *resource() const	{ return TableBase::get_allocator().resource();	}
 
-	Int64 rowOf(const OID &oid) const
+	// Rebuilds the indexes. Call it after changing row keys or indexed cells directly.
+	void reindex() const
 	{
+		mIndex.clear( TableBase::keyCount() );
+		mOrder.clear();
 		for( Int64 row = 0; row < TableBase::count(); ++row )
 		{
-			if( TableBase::at(row).machKeys(oid) )
-				return row;
+			mIndex.insert( TableBase::at(row).keys(), row );
+			mOrder.insert(row);
 		}
-		return -1;
+		mVersions.resize( TableBase::count() );
+
+		for( Int64 i = 0; i < mColumnIndexes.count(); ++i )
+		{
+			if( mColumnIndexes[i].isEnabled() )
+			{
+				mColumnIndexes[i].clear();
+				for( Int64 row = 0; row < TableBase::count(); ++row )
+					indexCell( mColumnIndexes[i], TableBase::at(row).cell(TableBase::firstColumn() + i), row );
+			}
+		}
+		mIndexedCount = TableBase::count();
+	}
+
+	// Indexes are rebuilt on the next lookup. Call it after changing row keys
+	// or indexed cells directly, if there are more changes to come.
+	void invalidateIndexes()	{ mIndexedCount = -1;	}
+	// Rebuilds stale indexes and sorts the rows in key order, so const lookups
+	// write nothing until the table is changed again.
+	void updateIndexes()
+	{
+		index();
+		orderedRows();
+	}
+
+	// Indexes the column values, so findCellRow() and newCellRowValue() don't scan the rows.
+	// Numbers and IP addresses are matched by value; the rest, by its bytes.
+	void indexColumn(Int64 column)
+	{
+		Int64 i = column - TableBase::firstColumn();
+		if( (i < 0) || (i >= TableBase::columnCount()) )
+			return;
+		if( mColumnIndexes.count() <= i )
+			mColumnIndexes.resize( TableBase::columnCount() );
+		if( !mColumnIndexes[i].isEnabled() )
+		{
+			mColumnIndexes[i].setEnabled(true);
+			reindex();
+		}
+	}
+	bool isColumnIndexed(Int64 column) const
+	{
+		Int64 i = column - TableBase::firstColumn();
+		return (i >= 0) && (i < mColumnIndexes.count()) && mColumnIndexes[i].isEnabled();
+	}
+
+	Int64 rowOf(const OID &oid) const
+	{
+		if( oid.count() < TableBase::keyCount() )
+			return -1;
+		UInt64 keysHash = TableKeyIndex::hash( oid.data() + (oid.count() - TableBase::keyCount()), TableBase::keyCount() );
+		return index().find( keysHash, [this, &oid](Int64 row) { return TableBase::at(row).machKeys(oid); } );
 	}
 	Int64 rowOf(const PDUVarbind &varBind) const
 	{
@@ -247,29 +973,199 @@ public:
 				Int64 row = rowOf( varBind.oid() );
 
 				if( row == -1 )
-				{
-					row = TableBase::count();
-					TableBase::append( T(TableBase::dataId()) );
-
-					// Copy the keys.
-					for( int key= 0; key < TableBase::keyCount(); ++key )
-						TableBase::last().key(key) = TableBase::oidKeyValue( varBind.oid(), key );
-				}
-				TableBase::at(row).cell(col) = varBind.asn1Variable();
+					row = newRow( varBind.oid(), TableBase::oidFirstKeyIndex() );
+				storeCell( row, col, varBind.asn1Variable() );
 				return row;
 			}
 		}
 		return -1;
 	}
+	// Row with the keys, added if there is none.
+	Int64 insertRow(const OID &keys)
+	{
+		if( keys.count() != TableBase::keyCount() )
+			return -1;
+		Int64 row = rowOf(keys);
+		return (row == -1) ? newRow(keys, 0) : row;
+	}
+	// Sets a key of a row, keeping indexes up to date. For changesSince(),
+	// the row with the old keys is removed and the one with the new keys added.
+	void setKey(Int64 row, Int64 keyIndex, const OIDValue &value)
+	{
+		index();
+		T &tableRow = TableBase::at(row);
+		if( tableRow.key(keyIndex) == value )
+			return;
+		OID oldKeys = tableRow.keys();
+		mIndex.unindex( oldKeys, row );
+		tableRow.key(keyIndex) = value;
+		mIndex.insert( tableRow.keys(), row );
+		mOrder.update(row);
+		mVersions.rekeyRow( row, oldKeys );
+	}
+	// Sets a cell of a row, keeping indexes and generations up to date.
+	void setCell(Int64 row, Int64 col, const ASN1Variable &value)
+	{
+		index();
+		storeCell( row, col, value );
+	}
+
+	// Sets the cells of many varbinds, as a GetBulk response or a walk brings.
+	// Unlike setCellData, nothing is written to std::cerr: every varbind
+	// outcome is returned instead, in the same order.
+	// Consecutive varbinds of the same row, as GetBulk sends them, find the
+	// row once.
+	template <typename Iterator>
+	StdVector<IngestOutcome> ingest(Iterator begin, Iterator end)
+	{
+		StdVector<IngestOutcome> outcomes;
+		const OID &base = TableBase::oidBase();
+		const Int64 baseCount = base.count();
+		const Int64 oidCount = TableBase::oidKeyIndex( static_cast<int>(TableBase::keyCount()) );
+		Int64 row = -1;
+
+		index();
+		for( Iterator it = begin; it != end; ++it )
+		{
+			const PDUVarbind &varBind = *it;
+			const OID &oid = varBind.oid();
+			IngestOutcome outcome = { IngestOutcome::NotInTable, -1 };
+
+			if( (oid.count() > baseCount) && oid.startsWith(base) )
+			{
+				Int64 col = static_cast<Int64>(oid[baseCount].toULongLong());
+				if( (col < TableBase::firstColumn()) || (col > TableBase::lastColumn()) )
+					outcome.result = IngestOutcome::BadColumn;
+				else
+				if( oid.count() != oidCount )
+					outcome.result = IngestOutcome::BadKeys;
+				else
+				{
+					if( (row == -1) || !TableBase::at(row).machKeys(oid) )
+						row = rowOf(oid);
+					if( row == -1 )
+					{
+						row = newRow( oid, TableBase::oidFirstKeyIndex() );
+						outcome.result = IngestOutcome::Added;
+					}
+					else
+						outcome.result = IngestOutcome::Updated;
+					storeCell( row, col, varBind.asn1Variable() );
+					outcome.row = row;
+				}
+			}
+			outcomes.append(outcome);
+		}
+		return outcomes;
+	}
+	template <typename Range>
+	StdVector<IngestOutcome> ingest(const Range &varbinds)
+	{
+		return ingest( std::begin(varbinds), std::end(varbinds) );
+	}
+
 	void removeRow(Int64 row)
 	{
 		if( (row >= 0) && (row < TableBase::count()) )
+		{
+			index();
+			mIndex.remove( TableBase::at(row).keys(), row );
+			mOrder.remove(row);
+			mVersions.removeRow( row, TableBase::at(row).keys() );
+			for( Int64 i = 0; i < mColumnIndexes.count(); ++i )
+			{
+				if( mColumnIndexes[i].isEnabled() )
+				{
+					unindexCell( mColumnIndexes[i], TableBase::at(row).cell(TableBase::firstColumn() + i), row );
+					mColumnIndexes[i].rowRemoved(row);
+				}
+			}
 			TableBase::removeAt(row);
+			mIndexedCount = TableBase::count();
+		}
 	}
 	void removeRow(const PDUVarbind &varBind)
 	{
 		removeRow( rowOf(varBind) );
 	}
+
+	// Generation of the last change. Keep it to ask for the changes since then.
+	UInt64 generation() const	{ return mVersions.generation();	}
+	// Rows added, rows removed and cells changed after generation.
+	// Rows added after generation and removed before now are not reported.
+	TableChanges changesSince(UInt64 generation) const
+	{
+		index();
+		return mVersions.changesSince( generation, TableBase::firstColumn() );
+	}
+	// Rows removed up to generation are not reported by changesSince() anymore.
+	void forgetChanges(UInt64 generation)	{ mVersions.forgetRemoved(generation);	}
+
+	// Mark and sweep refresh: rows not set between beginRefresh() and
+	// endRefresh(), by setCellData() or ingest(), are removed.
+	void beginRefresh()
+	{
+		index();
+		mRefreshGeneration = mVersions.nextGeneration();
+	}
+	// Returns the count of rows removed.
+	// The rows left are moved up and the indexes renumbered once for all the
+	// removed ones, so the sweep is linear in the table rows.
+	Int64 endRefresh()
+	{
+		index();
+		const Int64 count = TableBase::count();
+		StdVector<Int64> newRows;
+		newRows.reserve(count);
+		Int64 kept = 0;
+		for( Int64 row = 0; row < count; ++row )
+		{
+			if( mVersions.seen(row) >= mRefreshGeneration )
+			{
+				newRows.append(kept++);
+				continue;
+			}
+			newRows.append(-1);
+			mIndex.unindex( TableBase::at(row).keys(), row );
+			for( Int64 i = 0; i < mColumnIndexes.count(); ++i )
+				if( mColumnIndexes[i].isEnabled() )
+					unindexCell( mColumnIndexes[i], TableBase::at(row).cell(TableBase::firstColumn() + i), row );
+		}
+		if( kept == count )
+			return 0;
+
+		mVersions.removeRows( newRows, [this](Int64 row) -> const OID & { return TableBase::at(row).keys(); } );
+		mIndex.renumber(newRows);
+		mOrder.renumber(newRows);
+		for( TableValueIndex &columnIndex : mColumnIndexes )
+			if( columnIndex.isEnabled() )
+				columnIndex.renumber(newRows);
+		for( Int64 row = 0; row < count; ++row )
+			if( (newRows[row] != -1) && (newRows[row] != row) )
+				TableBase::at(newRows[row]) = std::move( TableBase::at(row) );
+		TableBase::erase( TableBase::begin() + kept, TableBase::end() );
+		mIndexedCount = TableBase::count();
+		return count - kept;
+	}
+
+	// Rows in key order, the GetNext one.
+	const StdVector<Int64> &orderedRows() const
+	{
+		return order().rows( TableBase::keyCount(), [this](Int64 row, Int64 k) { return keyAt(row, k); } );
+	}
+	// Row following keys in key order, as GetNext answers, or -1 if none.
+	Int64 nextRow(const OID &keys) const
+	{
+		auto keyAt = [this](Int64 row, Int64 k) { return this->keyAt(row, k); };
+		Int64 pos = order().upperBound( TableBase::keyCount(), keyAt, keys );
+		const StdVector<Int64> &rows = mOrder.rows( TableBase::keyCount(), keyAt );
+		return (pos < rows.count()) ? rows[pos] : -1;
+	}
+	// Positions [first, second), in orderedRows(), of the rows whose keys begins with prefix.
+	std::pair<Int64, Int64> keyRange(const OID &prefix) const
+	{
+		return order().prefixRange( TableBase::keyCount(), [this](Int64 row, Int64 k) { return keyAt(row, k); }, prefix );
+	}
 	// Hey, you. It's not a good idea to add functions that accepts
 	// snmp or varbindlist data because it may include non related OIDs
 	// and, for be sure that the incoming data is for the actual table,
@@ -279,24 +1175,15 @@ public:
 	Int64 keyRow( Int64 keyindex, const OIDValue &oid ) const
 	{
 		assert(keyindex < TableBase::keyCount());
-		for( int row = 0; row < TableBase::count(); ++row )
-		{
-			if( TableBase::at(row).key(keyindex) == oid )
-				return row;
-		}
-		return -1;
+		return index().keyRow( keyindex, oid.toULongLong() );
 	}
 	// Finds a new key for the key row index.
 	// It's usefull for new table intries
 	template<typename Num = UInt64>
 	Num newSequencialKeyRowValue( Int64 keyIndex, Num initialNumber = 1 ) const
 	{
-		UInt64 id = static_cast<UInt64>(initialNumber);
-
-		while( keyRow(keyIndex, SNMP::OIDValue(id)) != -1 )
-			++id;
-
-		return id;
+		assert(keyIndex < TableBase::keyCount());
+		return static_cast<Num>( index().freeKey(keyIndex, static_cast<UInt64>(initialNumber)) );
 	}
 	// Finds a new key for the key row index.
 	// It's usefull for new table intries
@@ -320,6 +1207,14 @@ public:
 	// Be sure before calling that column stores number values.
 	int findCellRow( Int64 column, Int64 value ) const
 	{
+		if( const TableValueIndex *columnIndex = this->columnIndex(column) )
+		{
+			return static_cast<int>( columnIndex->find( static_cast<UInt64>(value), [this, column, value](Int64 row)
+			{
+				const ASN1Variable &cell = TableBase::at(row).cell(column);
+				return isIntegerCell(cell) && (cell.toInteger() == value);
+			}) );
+		}
 		for( int row = 0; row < TableBase::count(); ++row )
 		{
 			if( TableBase::at(row).cell(column).toInteger() == value )
@@ -331,6 +1226,9 @@ public:
 	// It's usefull for new table entries where the entry must be unique per column.
 	Int64 newCellRowValue( Int64 column ) const
 	{
+		if( const TableValueIndex *columnIndex = this->columnIndex(column) )
+			return columnIndex->freeInteger(1);
+
 		Int64 id = 1;
 
 		while( findCellRow(column, id) != -1 )
@@ -342,6 +1240,15 @@ public:
 	// Be sure before calling that column stores string-type values (octet string, and so on).
 	int findCellRow( Int64 column, const StdString &value ) const
 	{
+		if( const TableValueIndex *columnIndex = this->columnIndex(column) )
+		{
+			ByteView bytes( reinterpret_cast<const Byte*>(value.data()), static_cast<Int64>(value.size()) );
+			return static_cast<int>( columnIndex->find( TableValueIndex::hash(bytes), [this, column, &bytes](Int64 row)
+			{
+				const ASN1Variable &cell = TableBase::at(row).cell(column);
+				return !isIntegerCell(cell) && (cell.octetStringView() == bytes);
+			}) );
+		}
 		for( int row = 0; row < TableBase::count(); ++row )
 		{
 			if( TableBase::at(row).cell(column).toStdString() == value )
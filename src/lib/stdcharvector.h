@@ -38,6 +38,9 @@ class StdByteVector : public StdVector<Byte>
 
 public:
 	StdByteVector() = default;
+	explicit StdByteVector(const Allocator<Byte> &allocator)
+		: StdVector<Byte> (allocator)
+	{	}
 
 	StdByteVector(const StdVector<Byte> &v)
 		: StdVector<Byte> (v)
@@ -89,10 +92,9 @@ public:
 	{
 		if( (pos + length) > count() )
 			length = static_cast<UInt32>(count() - pos);
-		StdByteVector rtn(length);
-		while( length-- > 0 )
-			rtn[length] = at(pos+length);
-
+		StdByteVector rtn;
+		if( length > 0 )
+			rtn.assign( begin() + pos, begin() + pos + length );
 		return rtn;
 	}
 	StdByteVector &append(Byte c)
@@ -107,6 +109,12 @@ public:
 		return *this;
 	}
 
+	StdByteVector &append(const Byte *b, Int64 length)
+	{
+		static_cast<StdVector<Byte> &>(*this).insert( std::end(*this), b, b + length );
+		return *this;
+	}
+
 	StdByteVector &append(const char *b)	{ return append( StdByteVector(b, static_cast<Int64>(strlen(b))) ); }
 	StdByteVector &append(const Byte *b)	{ return append( StdByteVector( reinterpret_cast<const char*>(b)) ); }
 
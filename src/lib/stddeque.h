@@ -23,34 +23,52 @@
 #define STDDEQUE_H
 
 #include <deque>
+#include <utility>
 #include <functional>
 
 #include "basic_types.h"
+#include "allocator.h"
 
 namespace SNMP {
 template <typename T>
-class StdDeque : public std::deque<T>
+class StdDeque : public std::deque<T, Allocator<T>>
 {
+	typedef std::deque<T, Allocator<T>> Base;
+
 public:
+	StdDeque() = default;
+	explicit StdDeque( const Allocator<T> &allocator )
+		: Base (allocator)
+	{	}
+
 	StdDeque &append(const StdDeque<T> &t)	{ StdDeque<T>::push_back(t);	}
-	void append(const T &t)					{ std::deque<T>::push_back(t);	}
+	void append(const T &t)					{ Base::push_back(t);	}
+	void append(T &&t)						{ Base::push_back(std::move(t));	}
+	// Constructs the item in place at the end.
+	template <typename... Args>
+	T &emplace(Args&&... args)
+	{
+		Base::emplace_back(std::forward<Args>(args)...);
+		return Base::back();
+	}
 
-	void removeAt(Int64 i)					{ std::deque<T>::erase( this->begin()+i );	}
+	void removeAt(Int64 i)					{ Base::erase( this->begin()+i );	}
 
 	StdDeque &operator+=(const StdDeque<T> t)		{ return append(t);	}
 	StdDeque &operator+=(const T &other)	{ append(other); return *this; 	}
 	StdDeque &operator<<(const T &other)	{ append(other); return *this;	}
+	StdDeque &operator<<(T &&other)			{ append(std::move(other)); return *this;	}
 
-	Int64 count()const		{ return static_cast<int>(std::deque<T>::size());	}
+	Int64 count()const		{ return static_cast<int>(Base::size());	}
 
-	const T &at(Int64 i) const	{ return std::deque<T>::at(i);	}
-	T &at(Int64 i)				{ return std::deque<T>::at(i);	}
+	const T &at(Int64 i) const	{ return Base::at(i);	}
+	T &at(Int64 i)				{ return Base::at(i);	}
 
-	const T &first() const	{ return std::deque<T>::front();	}
-	T &first()				{ return std::deque<T>::front();	}
+	const T &first() const	{ return Base::front();	}
+	T &first()				{ return Base::front();	}
 
-	const T &last() const	{ return std::deque<T>::back();	}
-	T &last()				{ return std::deque<T>::back();	}
+	const T &last() const	{ return Base::back();	}
+	T &last()				{ return Base::back();	}
 
 	bool isEmpty()			{ return count() == 0;	}
 
@@ -24,35 +24,46 @@
 #define STDLIST_H
 
 #include <list>
+#include <utility>
 
 #include "basic_types.h"
+#include "allocator.h"
 
 // This class doesn't have at() or operator[]() because it's a
 // linked list and such functions will be costly. Use StdDeque if need such functions.
 namespace SNMP {
 
 template <typename T>
-class StdList : public std::list<T>
+class StdList : public std::list<T, Allocator<T>>
 {
 public:
+	StdList() = default;
+	explicit StdList( const Allocator<T> &allocator )
+		: std::list<T, Allocator<T>> (allocator)
+	{	}
+
 	StdList &append(const StdList<T> &t)
 	{
-		std::list<T>::insert( std::end(*this), std::begin(t), std::end(t) );
+		std::list<T, Allocator<T>>::insert( std::end(*this), std::begin(t), std::end(t) );
 	}
 	StdList &operator+=(const StdList<T> t)		{ return append(t);	}
 	void append(const T &t)
 	{
 		this->push_back(t);
 	}
+	void append(T &&t)
+	{
+		this->push_back(std::move(t));
+	}
 	StdList &operator+=(const T &other)	{ append(other); return *this; 	}
 	StdList &operator<<(const T &other)	{ append(other); return *this;	}
-	Int64 count()const	{ return static_cast<Int64>(std::list<T>::size());	}
+	Int64 count()const	{ return static_cast<Int64>(std::list<T, Allocator<T>>::size());	}
 
-	const T &first() const	{ return std::list<T>::front();	}
-	T &first()				{ return std::list<T>::front();	}
+	const T &first() const	{ return std::list<T, Allocator<T>>::front();	}
+	T &first()				{ return std::list<T, Allocator<T>>::front();	}
 
-	const T &last() const	{ return std::list<T>::back();	}
-	T &last()				{ return std::list<T>::back();	}
+	const T &last() const	{ return std::list<T, Allocator<T>>::back();	}
+	T &last()				{ return std::list<T, Allocator<T>>::back();	}
 
 	bool isEmpty()			{ return count() == 0;	}
 };
@@ -24,60 +24,74 @@
 #define STDVECTOR_H
 
 #include <vector>
+#include <utility>
 #include "basic_types.h"
+#include "allocator.h"
 
 namespace SNMP {
 
 template<typename T>
-class StdVector : public std::vector<T>
+class StdVector : public std::vector<T, Allocator<T>>
 {
+	typedef std::vector<T, Allocator<T>> Base;
+
 public:
 	StdVector() = default;
+	explicit StdVector( const Allocator<T> &allocator )
+		: Base (allocator)
+	{	}
 	StdVector( const std::vector<T> &v )
-		: std::vector<T> (v)
+		: Base (v.begin(), v.end())
 	{	}
-	StdVector( typename std::vector<T>::size_type s )
-		: std::vector<T> (s)
+	StdVector( typename Base::size_type s )
+		: Base (s)
 	{	}
 	StdVector( Int64 initialSize )
-		: std::vector<T> (initialSize)
+		: Base (static_cast<typename Base::size_type>(initialSize))
 	{	}
 	StdVector( int initialSize )
-		: std::vector<T> (initialSize)
+		: Base (static_cast<typename Base::size_type>(initialSize))
 	{	}
 	StdVector( const T &t )
-		: std::vector<T>(1l)
+		: Base(1l)
 	{
 		at(0) = t;
 	}
 	StdVector( const T &t0, const T &t1 )
-		: std::vector<T>(2l)
+		: Base(2l)
 	{
 		at(0) = t0;
 		at(1) = t1;
 	}
 	StdVector( const T &t0, const T &t1, const T &t2 )
-		: std::vector<T>(3l)
+		: Base(3l)
 	{
 		at(0) = t0;
 		at(1) = t1;
 		at(2) = t2;
 	}
 	StdVector( const StdVector<T> &v )
-		: std::vector<T> (v)
+		: Base (v)
+	{	}
+	StdVector( StdVector<T> &&v )
+		: Base (std::move(v))
 	{	}
+	StdVector &operator=(const StdVector<T> &v) = default;
+	StdVector &operator=(StdVector<T> &&v) = default;
 
-	Int64 count()	const	{ return static_cast<Int64>(std::vector<T>::size());	}
-	void resize(Int64 i)	{ std::vector<T>::resize(static_cast<typename std::vector<T>::size_type>(i));	}
-	void reserve(Int64 i)	{ std::vector<T>::reserve(static_cast<typename std::vector<T>::size_type>(i));	}
+	Int64 count()	const	{ return static_cast<Int64>(Base::size());	}
+	void resize(Int64 i)	{ Base::resize(static_cast<typename Base::size_type>(i));	}
+	void resize(Int64 i, const T &t)	{ Base::resize(static_cast<typename Base::size_type>(i), t);	}
+	void reserve(Int64 i)	{ Base::reserve(static_cast<typename Base::size_type>(i));	}
 
-	void append(const T &t)					{ std::vector<T>::push_back(t);	}
-	void append(const StdVector<T> &t)		{ std::vector<T>::insert(std::end(*this), std::begin(t), std::end(t)); }
+	void append(const T &t)					{ Base::push_back(t);	}
+	void append(T &&t)						{ Base::push_back(std::move(t));	}
+	void append(const StdVector<T> &t)		{ Base::insert(std::end(*this), std::begin(t), std::end(t)); }
 
-	const T &operator[](Int64 i) const	{ return std::vector<T>::operator[](static_cast<typename std::vector<T>::size_type>(i));	}
-	T &operator[](Int64 i)				{ return std::vector<T>::operator[](static_cast<typename std::vector<T>::size_type>(i));	}
-	const T &at(Int64 i) const	{ return std::vector<T>::at(static_cast<typename std::vector<T>::size_type>(i));	}
-	T &at(Int64 i)				{ return std::vector<T>::at(static_cast<typename std::vector<T>::size_type>(i));	}
+	const T &operator[](Int64 i) const	{ return Base::operator[](static_cast<typename Base::size_type>(i));	}
+	T &operator[](Int64 i)				{ return Base::operator[](static_cast<typename Base::size_type>(i));	}
+	const T &at(Int64 i) const	{ return Base::at(static_cast<typename Base::size_type>(i));	}
+	T &at(Int64 i)				{ return Base::at(static_cast<typename Base::size_type>(i));	}
 
 	bool isEmpty() const	{ return count() == 0;	}
 };
@@ -0,0 +1,193 @@
+/**************************************************************************
+
+  Copyright 2015-2019 Rafael Dellà Bort. silderan (at) gmail (dot) com
+
+  This file is part of BasicSNMP
+
+  BasicSNMP is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+
+  BasicSNMP is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  and GNU Lesser General Public License. along with BasicSNMP.
+  If not, see <http://www.gnu.org/licenses/>.
+
+**************************************************************************/
+
+#ifndef TEXTWRITER_H
+#define TEXTWRITER_H
+
+#include <cstring>
+#include <ostream>
+
+#include "basic_types.h"
+#include "stdstring.h"
+#include "../utils.h"
+#include "oid.h"
+#include "asn1variable.h"
+#include "pduvarbind.h"
+
+namespace SNMP {
+
+// Text formatter for logging and exporting values.
+// Everything is appended into the same buffer, so no temporary strings are
+// created per value. If a stream is given, the buffer is written to it
+// every time it grows over the flush threshold and when flush() is called.
+// Without stream, the text is kept in the buffer until taken by text().
+class TextWriter
+{
+	StdString mBuffer;
+	std::ostream *mStream;
+	StdString::size_type mFlushSize;
+
+	void checkFlush()
+	{
+		if( mStream && (mBuffer.size() >= mFlushSize) )
+			flush();
+	}
+
+public:
+	explicit TextWriter(std::ostream *stream = nullptr, StdString::size_type flushSize = 4096)
+		: mStream(stream)
+		, mFlushSize(flushSize)
+	{
+		mBuffer.reserve(flushSize);
+	}
+	~TextWriter()
+	{
+		flush();
+	}
+
+	const StdString &text() const	{ return mBuffer;	}
+	// Clears the buffer keeping its capacity.
+	void clear()					{ mBuffer.clear();	}
+
+	void flush()
+	{
+		if( mStream && !mBuffer.empty() )
+		{
+			mStream->write( mBuffer.data(), static_cast<std::streamsize>(mBuffer.size()) );
+			mBuffer.clear();
+		}
+	}
+
+	TextWriter &write(char c)
+	{
+		mBuffer.push_back(c);
+		checkFlush();
+		return *this;
+	}
+	TextWriter &write(const char *text)
+	{
+		mBuffer.append(text);
+		checkFlush();
+		return *this;
+	}
+	TextWriter &write(const char *text, Int64 length)
+	{
+		mBuffer.append(text, static_cast<StdString::size_type>(length));
+		checkFlush();
+		return *this;
+	}
+	TextWriter &write(const StdString &text)
+	{
+		mBuffer.append(text);
+		checkFlush();
+		return *this;
+	}
+	TextWriter &writeInteger(Int64 value)
+	{
+		Utils::appendInteger(mBuffer, value);
+		checkFlush();
+		return *this;
+	}
+	TextWriter &writeUnsigned(UInt64 value)
+	{
+		Utils::appendUnsigned(mBuffer, value);
+		checkFlush();
+		return *this;
+	}
+	TextWriter &write(const OID &oid)
+	{
+		oid.appendTo(mBuffer);
+		checkFlush();
+		return *this;
+	}
+	TextWriter &write(const Utils::IPv4Address &ipv4)
+	{
+		Utils::appendIPv4Address(mBuffer, ipv4);
+		checkFlush();
+		return *this;
+	}
+	TextWriter &writeHex(const Byte *bytes, Int64 count, const char *sep = " ")
+	{
+		Utils::appendHexBytes(mBuffer, bytes, count, sep, strlen(sep));
+		checkFlush();
+		return *this;
+	}
+	TextWriter &writeHex(const StdByteVector &ba, const char *sep = " ")
+	{
+		return ba.count() ? writeHex(ba.bytes(), ba.count(), sep) : *this;
+	}
+
+	// Same text as asn1PrintableValue used by the GUI.
+	TextWriter &write(const ASN1Variable &asn1Var)
+	{
+		switch( asn1Var.type() )
+		{
+		case ASN1TYPE_BOOLEAN:		return write( asn1Var.toBoolean() ? "true" : "false" );
+		case ASN1TYPE_INTEGER:		return writeInteger( asn1Var.toInteger() );
+		case ASN1TYPE_NULL:			return write( "<null>" );
+		case ASN1TYPE_OBJECTID:		return write( asn1Var.toOID() );
+
+		case ASN1TYPE_OCTETSTRING:
+		case ASN1TYPE_NumericString:
+		case ASN1TYPE_TeletextString:
+		case ASN1TYPE_VideoString:
+		case ASN1TYPE_IA5String:
+		case ASN1TYPE_GraphicString:
+		case ASN1TYPE_GeneralString:
+		case ASN1TYPE_CharacterString:
+		{
+			ByteView view = asn1Var.octetStringView();
+			return write( view.chars(), view.count() );
+		}
+
+		case ASN1TYPE_UTCTime:
+		case ASN1TYPE_GeneralizeTime:
+		case ASN1TYPE_TimeTicks:
+			return writeUnsigned( asn1Var.toUnsigned64()/100 ).write( " secs" );
+
+		case ASN1TYPE_Counter:		return writeUnsigned( asn1Var.toCounter() );
+		case ASN1TYPE_Gauge32:		return writeUnsigned( asn1Var.toGauge32() );
+		case ASN1TYPE_Counter64:	return writeUnsigned( asn1Var.toCounter64() );
+		case ASN1TYPE_Integer64:	return writeInteger( asn1Var.toInteger64() );
+		case ASN1TYPE_Unsigned64:	return writeUnsigned( asn1Var.toUnsigned64() );
+
+		case ASN1TYPE_IPv4Address:	return write( asn1Var.toIPV4() );
+		default:
+			break;
+		}
+		// Lower case hex, as QString::arg() writes it in asn1PrintableValue.
+		static const char hexDigits[] = "0123456789abcdef";
+		Byte type = asn1Var.type();
+		write( "Unknown ASN1 value type: " ).writeUnsigned( type ).write( " (0x" );
+		return write( hexDigits[type >> 4] ).write( hexDigits[type & 0xF] ).write( ')' );
+	}
+
+	// Writes "oid = value".
+	TextWriter &write(const PDUVarbind &varbind)
+	{
+		return write( varbind.oid() ).write( " = " ).write( varbind.asn1Variable() );
+	}
+};
+
+} // namespace SNMP
+
+#endif // TEXTWRITER_H
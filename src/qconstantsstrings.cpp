@@ -73,7 +73,11 @@ const QMap<ASN1DataType, QString> &asn1TypeMap()
 		{ ASN1TYPE_GetNextRequestPDU,	"Contex_Constructed_GetNextRequestPDU" },
 		{ ASN1TYPE_ResponcePDU,			"Contex_Constructed_ResponcePDU" },
 		{ ASN1TYPE_SetRequestPDU,		"Contex_Constructed_SetRequestPDU" },
-		{ ASN1TYPE_TrapPDU,				"Contex_Constructed_TrapPDU" }
+		{ ASN1TYPE_TrapPDU,				"Contex_Constructed_TrapPDU" },
+		{ ASN1TYPE_GetBulkRequestPDU,	"Contex_Constructed_GetBulkRequestPDU" },
+		{ ASN1TYPE_InformRequestPDU,	"Contex_Constructed_InformRequestPDU" },
+		{ ASN1TYPE_TrapV2PDU,			"Contex_Constructed_TrapV2PDU" },
+		{ ASN1TYPE_ReportPDU,			"Contex_Constructed_ReportPDU" }
 		};
 
 	return info;
@@ -73,7 +73,15 @@ void SNMPConn::setTrapHost(quint16 trapPort)
 
 void SNMPConn::sendRequest(const Encoder &snmpDeco)
 {
-	StdByteVector data = snmpDeco.encodeRequest();
+	snmpDeco.encodeRequestInto(mSendBuffer);
+	qint64 writtenBytes = mAgentSocket.writeDatagram(mSendBuffer.chars(), mSendBuffer.count(), QHostAddress(mAgentAddress), mAgentPort);
+
+	Q_ASSERT( writtenBytes != -1 );
+}
+
+void SNMPConn::sendRequest(RequestTemplate &requestTemplate, int requestID)
+{
+	const StdByteVector &data = requestTemplate.datagram(requestID);
 	qint64 writtenBytes = mAgentSocket.writeDatagram(data.chars(), data.count(), QHostAddress(mAgentAddress), mAgentPort);
 
 	Q_ASSERT( writtenBytes != -1 );
@@ -188,33 +196,49 @@ void SNMPConn::play()
 	}
 }
 
+SNMP::SharedDatagram SNMPConn::readDatagram(QUdpSocket &socket)
+{
+	// The buffer is reused unless someone still holds a varbind raw value into it.
+	mReceived.clearRawValues();
+	if( !mReceiveBuffer || !mReceiveBuffer.unique() )
+		mReceiveBuffer = std::make_shared<StdByteVector>();
+	mReceiveBuffer->resize( static_cast<Int64>(socket.pendingDatagramSize()) );
+	socket.readDatagram( mReceiveBuffer->chars(), mReceiveBuffer->count() );
+	return mReceiveBuffer;
+}
+
 void SNMPConn::onDataReceived()
 {
 	if( mAgentSocket.hasPendingDatagrams() )
 	{
-		StdByteVector datagram( static_cast<Int64>(mAgentSocket.pendingDatagramSize()) );
-		mAgentSocket.readDatagram( datagram.chars(), datagram.count() );
-		Encoder snmp;
-		snmp.decodeAll(datagram, includeRawData());
+		// Shared, so the raw values of the decoded varbinds just point into it.
+		// Look at the request ID and the first OID before decoding anything.
+		MessageView message( readDatagram(mAgentSocket) );
 
-		if( !mRequestList.contains(snmp.requestID()) )
-			emit dataReceived(snmp);
+		if( !message.isValid() || !mRequestList.contains(message.requestID()) )
+		{
+			if( message.isValid() && !mDispatcher.isEmpty() )
+				mDispatcher.dispatch(message, includeRawData());
+			mReceived.decodeAll(message, includeRawData());
+			emit dataReceived(mReceived);
+		}
 		else
 		{
 			RequestInfo &ri = mRequestList.first();
-			Q_ASSERT(ri.requestID == snmp.requestID());
+			Q_ASSERT(ri.requestID == message.requestID());
 
-			if( snmp.varbindList().count() &&
-				snmp.varbindList().first().oid().startsWith(ri.initialOID) )
+			if( message.varbindCount() &&
+				message.begin()->oidStartsWith(ri.initialOID) )
 			{
-				emit tableCellReceived( snmp );
-				ri.requestOID = snmp.varbindList().first().oid();
+				mReceived.decodeAll(message, includeRawData());
+				emit tableCellReceived( mReceived );
+				ri.requestOID = mReceived.varbindList().first().oid();
 				play();
 			}
 			else
 			{
-				cancelDiscoverTable( snmp.requestID() );
-				emit tableReceived( snmp.requestID() );
+				cancelDiscoverTable( message.requestID() );
+				emit tableReceived( message.requestID() );
 			}
 		}
 	}
@@ -224,10 +248,10 @@ void SNMPConn::onTrapReceived()
 {
 	if( mTrapSocket.hasPendingDatagrams() )
 	{
-		StdByteVector datagram( static_cast<Int64>(mAgentSocket.pendingDatagramSize()) );
-		mAgentSocket.readDatagram( datagram.chars(), datagram.count() );
-		Encoder snmp;
-		snmp.decodeAll(datagram, includeRawData());
-		emit trapReceived(snmp);
+		MessageView message( readDatagram(mTrapSocket) );
+		if( message.isValid() && !mDispatcher.isEmpty() )
+			mDispatcher.dispatch(message, includeRawData());
+		mReceived.decodeAll(message, includeRawData());
+		emit trapReceived(mReceived);
 	}
 }
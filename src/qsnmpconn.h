@@ -38,6 +38,11 @@ Q_OBJECT
 	quint16 mTrapPort;
 	QUdpSocket mTrapSocket;
 	bool mIncludeRawData;		// This is usefull for debuging applications.
+	SNMP::StdByteVector mSendBuffer;	// Reused for every request to avoid allocations.
+	// Reused for every datagram received, so decoding doesn't allocate once warm.
+	std::shared_ptr<SNMP::StdByteVector> mReceiveBuffer;
+	SNMP::Encoder mReceived;
+	SNMP::VarbindDispatcher mDispatcher;
 
 	struct RequestInfo
 	{
@@ -112,6 +117,7 @@ Q_OBJECT
 	}mRequestList;
 
 	void play();
+	SNMP::SharedDatagram readDatagram(QUdpSocket &socket);
 	void onDataReceived();
 	void onTrapReceived();
 
@@ -126,7 +132,13 @@ public:
 	void setIncludeRawData(bool includeRawData = true)	{ mIncludeRawData = includeRawData;	}
 	bool includeRawData() const							{ return mIncludeRawData;	}
 
+	// Handlers called with the responses and traps varbinds under the registered OIDs.
+	// Only the varbinds with a handler are decoded for it. Signals are emited anyway.
+	SNMP::VarbindDispatcher &varbindDispatcher()				{ return mDispatcher;	}
+	const SNMP::VarbindDispatcher &varbindDispatcher() const	{ return mDispatcher;	}
+
 	void sendRequest(const SNMP::Encoder &snmpDeco);
+	void sendRequest(SNMP::RequestTemplate &requestTemplate, int requestID);
 
 	void sendGetRequest(int version, const SNMP::OID &oid, const QString &comunity, int requestID);
 	void sendGetRequest(int version, const QString &oid, const QString &comunity, int requestID)
@@ -26,13 +26,46 @@
 #include "lib/asn1encoder.h"
 #include "lib/asn1variable.h"
 #include "lib/snmpencoder.h"
+#include "lib/requesttemplate.h"
+#include "lib/messageview.h"
+#include "lib/compactoid.h"
+#include "lib/textwriter.h"
+#include "lib/oidregistry.h"
+#include "lib/oidprefixtree.h"
 #include "lib/snmptable.h"
+#include "lib/columntable.h"
+#include "lib/snapshot.h"
 
 #include <iostream>
+#include <chrono>
+#include <sstream>
 
 #include "qconstantsstrings.h"
 
 using namespace SNMP;
+
+// Allocation counter for the benchmarks: library containers created while
+// it's the default resource take its memory from it.
+class CountingResource : public MemoryResource
+{
+public:
+	Int64 allocations = 0;
+	Int64 bytesInUse = 0;
+
+	void *allocate(size_t size, size_t alignment) override
+	{
+		++allocations;
+		bytesInUse += static_cast<Int64>(size);
+		return newDeleteResource()->allocate(size, alignment);
+	}
+	void deallocate(void *p, size_t size, size_t alignment) override
+	{
+		bytesInUse -= static_cast<Int64>(size);
+		newDeleteResource()->deallocate(p, size, alignment);
+	}
+};
+static CountingResource allocationCounter;
+
 template<typename T>
 void testOneInteger(T value, const char *typeName, bool isUnsigned, const char *buff, int buffSize)
 {
@@ -201,6 +234,1285 @@ void testSNMPRequest()
 	std::cout << std::endl;
 }
 
+// Old-fashioned encoding, concatenating every TLV, to check that the
+// ASN1Writer used by Encoder::encodeRequest() produces exactly the same.
+StdByteVector legacyEncodeRequest(const SNMP::Encoder &snmp)
+{
+	StdByteVector varbindEncoded;
+	for( const PDUVarbind &varbind : snmp.varbindList() )
+	{
+		varbindEncoded += ASN1Encoder::encodeSequence(StdByteVectorList()
+													 << ASN1Encoder::encodeObjectIdentifier(varbind.oid())
+													 << ASN1Encoder::encodeUnknown(varbind.asn1Variable()) );
+	}
+	return ASN1Encoder::encodeSequence( StdByteVectorList()
+										<< ASN1Encoder::encodeInteger(snmp.version(), ASN1TYPE_INTEGER, true)
+										<< ASN1Encoder::encodeOctetString(snmp.comunity())
+										<< ASN1Encoder::encodeList(snmp.requestType(),
+																  StdByteVectorList()
+																	<< ASN1Encoder::encodeInteger(snmp.requestID(), ASN1TYPE_INTEGER, false)
+																	<< ASN1Encoder::encodeInteger(0, ASN1TYPE_INTEGER, true)
+																	<< ASN1Encoder::encodeInteger(0, ASN1TYPE_INTEGER, true)
+																	<< ASN1Encoder::encodeSequence(StdByteVectorList() << varbindEncoded) ) );
+}
+
+void testSNMPRequestWriter()
+{
+	PDUVarbindList varbindList;
+	ASN1Variable asn1Var;
+	for( int i = 0; i < 40; ++i )
+	{
+		switch( i % 6 )
+		{
+		case 0: asn1Var.setNull();						break;
+		case 1: asn1Var.setInteger(-129 * i);			break;
+		case 2: asn1Var.setCounter64(0xFF00000000ull + static_cast<UInt64>(i));	break;
+		case 3: asn1Var.setOctetString(StdString(static_cast<size_t>(i * 10), 'x'));	break;
+		case 4: asn1Var.setOID("1.3.6.1.2.1.2.2.1.10." + std::to_string(i * 1000));	break;
+		case 5: asn1Var.setIPv4(Utils::IPv4Address(192, 168, 0, static_cast<Byte>(i)));	break;
+		}
+		varbindList.append( PDUVarbind("1.3.6.1.4.1.2680.1.2.7.3." + std::to_string(i * 300) + ".0", asn1Var) );
+	}
+	SNMP::Encoder snmpRequest;
+	snmpRequest.setupSetRequest( 1, StdString(200, 'c'), 0x12345678, varbindList );
+
+	std::cout << ((snmpRequest.encodeRequest() == legacyEncodeRequest(snmpRequest)) ? "Ok" : "Fail") << " Encoder::encodeRequest() big request" << std::endl;
+
+	snmpRequest.setupGetRequest( 0, "public", -1, OID("1.3.6.1.2.1.1.1.0") );
+	std::cout << ((snmpRequest.encodeRequest() == legacyEncodeRequest(snmpRequest)) ? "Ok" : "Fail") << " Encoder::encodeRequest() small request" << std::endl;
+	std::cout << std::endl;
+}
+
+void testSNMPRequestInto()
+{
+	SNMP::Encoder snmpRequest;
+	snmpRequest.setupGetRequest( 1, "public", 12345, OIDList("1.3.6.1.2.1.1.1.0", "1.3.6.1.2.1.1.5.0") );
+	StdByteVector expected = snmpRequest.encodeRequest();
+
+	Byte buffer[256];
+	Int64 size = 0;
+	std::cout << ((!snmpRequest.encodeRequestInto(buffer, 10, size) && (size == expected.count())) ? "Ok" : "Fail") << " Encoder::encodeRequestInto() too small buffer " << size << std::endl;
+	std::cout << ((snmpRequest.encodeRequestInto(buffer, sizeof(buffer), size) && (StdByteVector(reinterpret_cast<const char*>(buffer), size) == expected)) ? "Ok" : "Fail") << " Encoder::encodeRequestInto() buffer" << std::endl;
+
+	StdByteVector ba;
+	snmpRequest.encodeRequestInto(ba);
+	const Byte *data = ba.bytes();
+	snmpRequest.setRequestID( 12346 );
+	snmpRequest.encodeRequestInto(ba);
+	std::cout << (((ba == snmpRequest.encodeRequest()) && (ba.bytes() == data)) ? "Ok" : "Fail") << " Encoder::encodeRequestInto() reused vector" << std::endl;
+	std::cout << std::endl;
+}
+
+void testRequestTemplate()
+{
+	SNMP::Encoder snmpRequest;
+	snmpRequest.setupGetRequest( 1, "public", 0x12345678, OIDList("1.3.6.1.2.1.1.1.0", "1.3.6.1.2.1.1.5.0") );
+
+	RequestTemplate requestTemplate(snmpRequest);
+	std::cout << ((requestTemplate.datagram() == snmpRequest.encodeRequest()) ? "Ok" : "Fail") << " RequestTemplate::datagram()" << std::endl;
+
+	for( int requestID : StdVector<int>(0x7FFFFFFF, 5, 0x800000) )
+	{
+		SNMP::Encoder snmpResponce;
+		snmpResponce.decodeAll(requestTemplate.datagram(requestID), false);
+		std::cout << (((snmpResponce.requestID() == requestID) && (requestTemplate.requestID() == requestID) && (snmpResponce.varbindList().count() == 2)) ? "Ok" : "Fail") << " RequestTemplate::setRequestID(" << requestID << ")" << std::endl;
+	}
+	std::cout << std::endl;
+}
+
+void testMessageView()
+{
+	PDUVarbindList varbindList;
+	ASN1Variable asn1Var;
+	asn1Var.setInteger(-12345);
+	varbindList << PDUVarbind("1.3.6.1.2.1.2.2.1.10.1", asn1Var);
+	asn1Var.setOctetString(StdString("eth0"));
+	varbindList << PDUVarbind("1.3.6.1.2.1.2.2.1.2.1", asn1Var);
+	asn1Var.setIPv4(Utils::IPv4Address(10, 0, 0, 1));
+	varbindList << PDUVarbind("1.3.6.1.2.1.4.20.1.1.10.0.0.1", asn1Var);
+
+	SNMP::Encoder snmpRequest;
+	snmpRequest.setupSetRequest( 1, "private", 4321, varbindList );
+	StdByteVector ba = snmpRequest.encodeRequest();
+
+	MessageView view(ba);
+	std::cout << ((view.isValid() && (view.version() == 1) && (view.comunity().toStdString() == "private") &&
+				   (view.requestID() == 4321) && (view.requestType() == ASN1TYPE_SetRequestPDU) && (view.varbindCount() == 3)) ? "Ok" : "Fail") << " MessageView::parse() ErrorCode=" << view.errorCode() << std::endl;
+
+	Int64 i = 0;
+	for( const MessageView::Varbind &varbind : view )
+	{
+		const PDUVarbind &expected = varbindList.at(i++);
+		std::cout << (((varbind.oid() == expected.oid()) && varbind.oidStartsWith("1.3.6.1.2.1") && !varbind.oidStartsWith("1.3.6.1.2.1.3")) ? "Ok" : "Fail") << " MessageView::Varbind::oid() " << varbind.oid().toStdString() << std::endl;
+		std::cout << (((varbind.valueType() == expected.asn1Variable().type()) &&
+					   (ASN1Encoder::encodeUnknown(varbind.asn1Variable()) == ASN1Encoder::encodeUnknown(expected.asn1Variable()))) ? "Ok" : "Fail") << " MessageView::Varbind::asn1Variable()" << std::endl;
+	}
+
+	ba.resize( ba.count() - 1 );
+	std::cout << ((!view.parse(ba) && (view.begin() == view.end())) ? "Ok" : "Fail") << " MessageView::parse() interrupted datagram. ErrorCode=" << view.errorCode() << std::endl;
+	std::cout << std::endl;
+}
+
+void testLazyVarbinds()
+{
+	OIDList oidList;
+	for( int i = 1; i <= 40; ++i )
+		oidList.append( OID("1.3.6.1.2.1.2.2.1.10." + std::to_string(i)) );
+
+	SNMP::Encoder snmpRequest;
+	snmpRequest.setupGetRequest( 1, "public", 1, oidList );
+	StdByteVector ba = snmpRequest.encodeRequest();
+
+	SNMP::Encoder snmpResponce;
+	snmpResponce.decodeAll(ba, true);
+	MessageView message(ba);
+
+	Int64 i = 0;
+	bool ok = true;
+	for( const PDUVarbind &varbind : message.varbinds(true) )
+	{
+		const PDUVarbind &expected = snmpResponce.varbindList().at(i++);
+		ok &= (varbind.oid() == expected.oid()) && (varbind.rawValue() == expected.rawValue()) && (varbind.asn1Variable().type() == expected.asn1Variable().type());
+	}
+	std::cout << ((ok && (i == 40)) ? "Ok" : "Fail") << " MessageView::varbinds()" << std::endl;
+
+	TableInfo tableInfo("1.3.6.1.2.1.2.2.1", message);
+	std::cout << (((tableInfo.column == 10) && (tableInfo.keyIndexes == OID("1"))) ? "Ok" : "Fail") << " TableInfo::interpret(MessageView)" << std::endl;
+
+	// The second value becomes an IP address of 3 bytes: its varbind is not
+	// decoded, nothing of the first one is left on it and the loop ends.
+	PDUVarbindList varbindList;
+	ASN1Variable asn1Var;
+	for( int value : { 1, 0x10000, 3 } )
+	{
+		asn1Var.setInteger(value);
+		varbindList << PDUVarbind( OID("1.3.6.1.2.1.2.2.1.10." + std::to_string(value)), asn1Var );
+	}
+	snmpRequest.setupSetRequest( 1, "private", 1, varbindList );
+	ba = snmpRequest.encodeRequest();
+	const Byte corruptValue[] = { ASN1TYPE_INTEGER, 3, 0x01, 0x00, 0x00 };
+	Int64 valuePos = std::search( ba.begin(), ba.end(), std::begin(corruptValue), std::end(corruptValue) ) - ba.begin();
+	ba[valuePos] = ASN1TYPE_IPv4Address;
+	message.parse(ba);
+	StdVector<ASN1Encoder::ErrorCode> errorCodes;
+	StdVector<PDUVarbind> varbinds;
+	for( auto it = message.varbinds().begin(); it != message.varbinds().end(); ++it )
+	{
+		varbinds.append( *it );
+		errorCodes.append( it.errorCode() );
+	}
+	ok = message.isValid() && (varbinds.count() == 2) &&
+		 (errorCodes[0] == ASN1Encoder::ErrorCode::NoError) && (varbinds[0].asn1Variable().toInteger() == 1) &&
+		 (errorCodes[1] != ASN1Encoder::ErrorCode::NoError) && varbinds[1].oid().isEmpty() && (varbinds[1].asn1Variable().type() == ASN1TYPE_NULL);
+	std::cout << (ok ? "Ok" : "Fail") << " MessageView::varbinds() corrupt value" << std::endl;
+	std::cout << std::endl;
+}
+
+void testCompactOID()
+{
+	CompactOID shortOID("1.3.6.1.2.1.2.2.1.10.12345");
+	CompactOID longOID;
+	for( CompactOID::Arc arc = 0; arc < 30; ++arc )
+		longOID.append( arc * 1000 );
+
+	std::cout << (((shortOID.toOID() == OID("1.3.6.1.2.1.2.2.1.10.12345")) && (shortOID.toStdString() == ".1.3.6.1.2.1.2.2.1.10.12345")) ? "Ok" : "Fail") << " CompactOID::toOID() " << shortOID.toStdString() << std::endl;
+	std::cout << ((shortOID.startsWith("1.3.6.1.2.1.2.2") && shortOID.endsWith("10.12345") && !shortOID.startsWith("1.3.6.1.2.1.2.3") && !shortOID.endsWith("11.12345")) ? "Ok" : "Fail") << " CompactOID::startsWith() CompactOID::endsWith()" << std::endl;
+
+	CompactOID copy(longOID);
+	CompactOID moved(std::move(copy));
+	OID oid = moved;
+	std::cout << (((moved == longOID) && (oid.count() == 30) && (oid[29] == 29000) && (CompactOID(oid) == longOID) && (copy != longOID)) ? "Ok" : "Fail") << " CompactOID heap copy/move" << std::endl;
+	std::cout << (((CompactOID("1.3.6.1.2") < CompactOID("1.3.6.1.10")) && (CompactOID("1.3.6") < CompactOID("1.3.6.1")) && !(shortOID < shortOID)) ? "Ok" : "Fail") << " CompactOID::operator<()" << std::endl;
+	// Arcs over 32 bits are not truncated, nor taken as an empty OID, which would be the prefix of all.
+	int thrown = 0;
+	for( const char *text : { "1.3.6.1.18446744073709551615", "1.3.6.1.4294967296" } )
+	{
+		try { CompactOID big = CompactOID( OID(text) ); }
+		catch( const std::out_of_range & )	{ ++thrown; }
+	}
+	std::cout << (((thrown == 2) && (CompactOID("1.3.6.1.4294967295").at(4) == 0xFFFFFFFFu)) ? "Ok" : "Fail") << " CompactOID arcs over 32 bits" << std::endl;
+	std::cout << std::endl;
+}
+
+void testOIDParse()
+{
+	OID oid;
+	Int64 errorPos = -1;
+	std::cout << ((OID::parse(".1.3.6.1.2.1..2.", oid) && (oid.toStdString() == ".1.3.6.1.2.1.2")) ? "Ok" : "Fail") << " OID::parse() " << oid.toStdString() << std::endl;
+	std::cout << ((!OID::parse("1.3.6.x.1", oid, &errorPos) && oid.isEmpty() && (errorPos == 6)) ? "Ok" : "Fail") << " OID::parse() wrong character" << std::endl;
+	std::cout << ((!OID::parse("1.3.18446744073709551616", oid, &errorPos) && (errorPos == 23)) ? "Ok" : "Fail") << " OID::parse() overflow" << std::endl;
+	std::cout << ((OID::parse("1.3.18446744073709551615", oid) && (oid[2] == 18446744073709551615ull)) ? "Ok" : "Fail") << " OID::parse() max value" << std::endl;
+	// Constructors throw on malformed text, as std::stoull did before.
+	int thrown = 0;
+	for( const char *text : { "1.3.6.x", "1.3.-6", "1.3.18446744073709551616" } )
+	{
+		try { OID malformed(text); }
+		catch( const std::invalid_argument & )	{ ++thrown; }
+		catch( const std::out_of_range & )		{ thrown += 10; }
+	}
+	std::cout << ((thrown == 12) ? "Ok" : "Fail") << " OID() malformed text throws" << std::endl;
+
+	// Benchmark against the old split based parsing.
+	const int loops = 100000;
+	StdString text("1.3.6.1.2.1.2.2.1.10.12345");
+	auto t0 = std::chrono::steady_clock::now();
+	for( int i = 0; i < loops; ++i )
+	{
+		StdVector<StdString> bits = Utils::split(text, '.');
+		OID old(bits.count());
+		for( Int64 b = 0; b < bits.count(); ++b )
+			old[b] = OIDValue(bits[b]);
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	for( int i = 0; i < loops; ++i )
+		OID::parse(text, oid);
+	auto t2 = std::chrono::steady_clock::now();
+	std::cout << "OID parsing " << loops << " times. Split: " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()
+			  << "us OID::parse(): " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << "us" << std::endl;
+	std::cout << std::endl;
+}
+
+void testTextWriter()
+{
+	TextWriter writer;
+	writer.writeInteger(-9223372036854775807ll - 1).write(' ').writeUnsigned(18446744073709551615ull).write(' ').writeInteger(0);
+	std::cout << ((writer.text() == "-9223372036854775808 18446744073709551615 0") ? "Ok" : "Fail") << " TextWriter integers " << writer.text() << std::endl;
+
+	writer.clear();
+	PDUVarbind varbind( OID("1.3.6.1.2.1.4.20.1.1.10.0.0.1") );
+	varbind.asn1Variable().setIPv4(Utils::IPv4Address(10, 0, 0, 1));
+	writer.write(varbind);
+	std::cout << ((writer.text() == ".1.3.6.1.2.1.4.20.1.1.10.0.0.1 = 10.0.0.1") ? "Ok" : "Fail") << " TextWriter varbind " << writer.text() << std::endl;
+
+	// Same text as asn1PrintableValue(): "arg(type, 2, 16, QChar('0'))" writes lower case hex.
+	writer.clear();
+	ASN1Variable unknown;
+	unknown.setData( 0xA9, reinterpret_cast<const Byte*>("x"), 1 );
+	writer.write(unknown);
+	std::cout << ((writer.text() == "Unknown ASN1 value type: 169 (0xa9)") ? "Ok" : "Fail") << " TextWriter unknown type " << writer.text() << std::endl;
+
+	StdByteVector bytes;
+	bytes.push_back(0x00);
+	bytes.push_back(0xAF);
+	bytes.push_back(0x5C);
+	writer.clear();
+	writer.writeHex(bytes, ":");
+	std::cout << (((writer.text() == "00:AF:5C") && (Utils::printableBytes(bytes, " ") == "00 AF 5C")) ? "Ok" : "Fail") << " TextWriter::writeHex() " << writer.text() << std::endl;
+
+	std::ostringstream stream;
+	{
+		TextWriter streamWriter(&stream, 16);
+		for( int i = 0; i < 10; ++i )
+			streamWriter.write( OID("1.3.6.1.2.1.1") ).write('\n');
+	}
+	std::cout << ((stream.str().size() == 150) ? "Ok" : "Fail") << " TextWriter stream flush" << std::endl;
+
+	const int loops = 100000;
+	OID oid("1.3.6.1.2.1.2.2.1.10.12345");
+	StdString text;
+	auto t0 = std::chrono::steady_clock::now();
+	for( int i = 0; i < loops; ++i )
+	{
+		text.clear();
+		for( OIDValue val : oid )
+			text += "." + val.toStdString();
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	for( int i = 0; i < loops; ++i )
+	{
+		text.clear();
+		oid.appendTo(text);
+	}
+	auto t2 = std::chrono::steady_clock::now();
+	std::cout << "OID formatting " << loops << " times. Concatenating: " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()
+			  << "us OID::appendTo(): " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << "us" << std::endl;
+	std::cout << std::endl;
+}
+
+void testOIDRegistry()
+{
+	OIDRegistry registry;
+	OIDRegistry::Handle ifTable = registry.intern("1.3.6.1.2.1.2.2.1");
+	OIDRegistry::Handle ifInOctets = registry.intern("1.3.6.1.2.1.2.2.1.10.3");
+	OIDRegistry::Handle sysDescr = registry.intern( CompactOID("1.3.6.1.2.1.1.1.0") );
+
+	std::cout << (((registry.intern("1.3.6.1.2.1.2.2.1.10.3") == ifInOctets) && (registry.find( OID("1.3.6.1.2.1.2.2.1") ) == ifTable) && (registry.find( OID("1.3.6.1.2.1.2.2.2") ) == OIDRegistry::InvalidHandle)) ? "Ok" : "Fail") << " OIDRegistry::intern() OIDRegistry::find()" << std::endl;
+	std::cout << ((registry.startsWith(ifInOctets, ifTable) && !registry.startsWith(sysDescr, ifTable) && (registry.parent(registry.parent(ifInOctets)) == ifTable) && (registry.depth(ifInOctets) == 11)) ? "Ok" : "Fail") << " OIDRegistry::startsWith()" << std::endl;
+	std::cout << (((registry.oid(ifInOctets) == OID("1.3.6.1.2.1.2.2.1.10.3")) && (registry.toStdString(sysDescr) == ".1.3.6.1.2.1.1.1.0")) ? "Ok" : "Fail") << " OIDRegistry::oid() " << registry.toStdString(sysDescr) << std::endl;
+
+	// Many handles to force rehashing.
+	bool ok = true;
+	for( UInt32 i = 0; i < 5000; ++i )
+		ok &= registry.intern( registry.intern(ifTable, i % 22), i ) == registry.find( OID("1.3.6.1.2.1.2.2.1." + std::to_string(i % 22) + "." + std::to_string(i)) );
+	std::cout << ((ok && (registry.find( OID("1.3.6.1.2.1.2.2.1.10.3") ) == ifInOctets)) ? "Ok" : "Fail") << " OIDRegistry rehash" << std::endl;
+
+	// OIDs with arcs over 32 bits are found only as OIDs: they cannot become CompactOIDs.
+	OID bigArcOID("1.3.6.1.2.1.2.2.1.10.18446744073709551615");
+	ok = registry.find(bigArcOID) == OIDRegistry::InvalidHandle;
+	try { ok &= registry.find( CompactOID(bigArcOID) ) == OIDRegistry::InvalidHandle; ok = false; }
+	catch( const std::out_of_range & )	{ }
+	OIDRegistry::Handle bigArc = registry.intern(bigArcOID);
+	ok &= (bigArc != ifTable) && (registry.find(bigArcOID) == bigArc) && (registry.lastArc(bigArc) == 18446744073709551615ull);
+	std::cout << (ok ? "Ok" : "Fail") << " OIDRegistry arcs over 32 bits" << std::endl;
+
+	Encoder snmpResponce;
+	snmpResponce.setRequestType(ASN1TYPE_ResponcePDU);
+	snmpResponce.addPDUVar( PDUVarbind( OID("1.3.6.1.2.1.2.2.1.10.3") ) );
+	snmpResponce.addPDUVar( PDUVarbind( OID("1.3.6.1.2.1.2.2.1.10.4000000") ) );
+	StdByteVector datagram = snmpResponce.encodeRequest();
+	MessageView message;
+	message.parse( datagram );
+	MessageView::const_iterator it = message.begin();
+	OIDRegistry::Handle first = registry.find( it->oidBytes() );
+	OIDRegistry::Handle second = registry.find( (++it)->oidBytes() );
+	std::cout << (((first == ifInOctets) && (second == OIDRegistry::InvalidHandle)) ? "Ok" : "Fail") << " OIDRegistry::find(ByteView)" << std::endl;
+	std::cout << std::endl;
+}
+
+void testVarbindDispatcher()
+{
+	int ifTableCount = 0;
+	int ifInOctetsCount = 0;
+	int systemCount = 0;
+	VarbindDispatcher dispatcher;
+	dispatcher.insert( OID("1.3.6.1.2.1.2.2"), [&ifTableCount](const PDUVarbind &) { ++ifTableCount; } );
+	dispatcher.insert( OID("1.3.6.1.2.1.2.2.1.10"), [&ifInOctetsCount](const PDUVarbind &) { ++ifInOctetsCount; } );
+	dispatcher.insert( OID("1.3.6.1.2.1.1"), [&systemCount](const PDUVarbind &) { ++systemCount; } );
+
+	Int64 prefixLength = 0;
+	dispatcher.longestMatch( OID("1.3.6.1.2.1.2.2.1.10.3"), &prefixLength );
+	std::cout << (((prefixLength == 10) && (dispatcher.longestMatch( OID("1.3.6.1.2.1.3") ) == nullptr)) ? "Ok" : "Fail") << " OIDPrefixTree::longestMatch()" << std::endl;
+
+	Encoder snmpResponce;
+	snmpResponce.setRequestType(ASN1TYPE_ResponcePDU);
+	snmpResponce.addPDUVar( PDUVarbind( OID("1.3.6.1.2.1.2.2.1.10.3") ) );
+	snmpResponce.addPDUVar( PDUVarbind( OID("1.3.6.1.2.1.2.2.1.2.3") ) );
+	snmpResponce.addPDUVar( PDUVarbind( OID("1.3.6.1.2.1.1.5.0") ) );
+	snmpResponce.addPDUVar( PDUVarbind( OID("1.3.6.1.2.1.4.20.1.1.10.0.0.1") ) );
+	StdByteVector datagram = snmpResponce.encodeRequest();
+	MessageView message(datagram);
+	Int64 dispatched = dispatcher.dispatch(message);
+	std::cout << (((dispatched == 3) && (ifInOctetsCount == 1) && (ifTableCount == 1) && (systemCount == 1)) ? "Ok" : "Fail") << " VarbindDispatcher::dispatch(MessageView)" << std::endl;
+
+	dispatcher.remove( OID("1.3.6.1.2.1.2.2.1.10") );
+	dispatcher.dispatch( PDUVarbind( OID("1.3.6.1.2.1.2.2.1.10.3") ) );
+	std::cout << (((ifTableCount == 2) && (ifInOctetsCount == 1) && (dispatcher.count() == 2) && !dispatcher.remove( OID("1.3.6.1.2.1.2.2.1.10") )) ? "Ok" : "Fail") << " OIDPrefixTree::remove()" << std::endl;
+	std::cout << std::endl;
+}
+
+void testASN1VariableStorage()
+{
+	ASN1Variable shortString;
+	shortString.setOctetString( StdString("eth0") );
+	ASN1Variable longString;
+	longString.setOctetString( StdString(100, 'x') );
+	ASN1Variable longOID;
+	longOID.setOID( OID("1.3.6.1.4.1.9.9.18446744073709551615.1.2.3.4.5.6.7.8.9.10.11.12.13.14.15") );
+
+	ASN1Variable copy(longString);
+	ASN1Variable moved(std::move(copy));
+	copy = shortString;
+	std::cout << (((sizeof(ASN1Variable) == 24) && (moved.toStdString() == StdString(100, 'x')) && (copy.toStdString() == "eth0") && (longString.octetStringView().count() == 100)) ? "Ok" : "Fail") << " ASN1Variable copy/move" << std::endl;
+
+	copy = longOID;
+	longOID.setInteger(-5);
+	std::cout << (((copy.toOID() == OID("1.3.6.1.4.1.9.9.18446744073709551615.1.2.3.4.5.6.7.8.9.10.11.12.13.14.15")) && (longOID.toInteger() == -5) && copy.toOctetString().isEmpty()) ? "Ok" : "Fail") << " ASN1Variable::toOID() " << copy.toOID().toStdString() << std::endl;
+
+	StdByteVector ber = ASN1Encoder::encodeObjectIdentifier( OID("1.3.6.1.2.1.2.2.1.10.12345") );
+	ASN1Variable fromBER;
+	fromBER.setOIDFromBER( ber.bytes() + 2, ber.count() - 2 );
+	std::cout << ((fromBER.toOID() == OID("1.3.6.1.2.1.2.2.1.10.12345")) ? "Ok" : "Fail") << " ASN1Variable::setOIDFromBER() " << fromBER.toOID().toStdString() << std::endl;
+	std::cout << std::endl;
+}
+
+// Varbind list decoding as it was before move semantics: a scratch varbind
+// decoded and then copied into the list.
+bool legacyDecodeAll(const StdByteVector &ba, bool includeRawData, PDUVarbindList &varbindList)
+{
+	ASN1Encoder::ErrorCode errorCode = ASN1Encoder::ErrorCode::NoError;
+	Int64 pos = 0;
+	Int64 length;
+	int number;
+	StdByteVector comunity;
+	if( !ASN1Encoder::decodeSequence(errorCode, ba, pos, length) ||
+		!ASN1Encoder::decodeInteger(errorCode, number, ba, pos, true) ||
+		!ASN1Encoder::decodeOctetString(errorCode, comunity, ba, pos) ||
+		!ASN1Encoder::decodePDURequest(errorCode, ba, pos) ||
+		!ASN1Encoder::decodeInteger(errorCode, number, ba, pos, true) ||
+		!ASN1Encoder::decodeInteger(errorCode, number, ba, pos, false) ||
+		!ASN1Encoder::decodeInteger(errorCode, number, ba, pos, false) ||
+		!ASN1Encoder::decodeSequence(errorCode, ba, pos, length) )
+		return false;
+
+	PDUVarbind pduVar;
+	StdByteVector rawValue;
+	varbindList.clear();
+	while( pos < ba.count() )
+	{
+		if( !ASN1Encoder::decodeSequence(errorCode, ba, pos, length) ||
+			!ASN1Encoder::decodeObjectIdentifier(errorCode, pduVar.oid(), ba, pos) ||
+			!ASN1Encoder::decodeUnknown(errorCode, ba, pos, pduVar.asn1Variable(), includeRawData ? &rawValue : nullptr) )
+			return false;
+		if( includeRawData )
+			pduVar.setRawValue(rawValue);
+		const PDUVarbind &copy = pduVar;
+		varbindList.append(copy);
+	}
+	return true;
+}
+
+void testMoveSemantics()
+{
+	Encoder snmpResponce;
+	snmpResponce.setupGetRequest( 1, "public", 1234, OID("1.3.6.1.2.1.2.2.1.2.1") );
+	snmpResponce.setRequestType(ASN1TYPE_ResponcePDU);
+	for( int i = 1; i <= 20; ++i )
+	{
+		ASN1Variable asn1Var;
+		asn1Var.setOctetString( StdString("GigabitEthernet0/") + std::to_string(i) + " uplink to the core switch" );
+		snmpResponce.emplacePDUVar( OID("1.3.6.1.2.1.2.2.1.2." + std::to_string(i)), std::move(asn1Var) );
+	}
+	StdByteVector datagram = snmpResponce.encodeRequest();
+
+	MemoryResource *previousResource = setDefaultResource(&allocationCounter);
+	const int loops = 1000;
+	PDUVarbindList legacyList;
+	Encoder snmp;
+	allocationCounter.allocations = 0;
+	for( int i = 0; i < loops; ++i )
+		legacyDecodeAll(datagram, true, legacyList);
+	Int64 legacyCount = allocationCounter.allocations;
+	allocationCounter.allocations = 0;
+	for( int i = 0; i < loops; ++i )
+		snmp.decodeAll(datagram, true);
+	Int64 moveCount = allocationCounter.allocations;
+
+	bool ok = snmp.varbindList().count() == legacyList.count();
+	for( Int64 i = 0; ok && (i < legacyList.count()); ++i )
+		ok = (snmp.varbindList().at(i).oid() == legacyList.at(i).oid()) && (snmp.varbindList().at(i).rawValue() == legacyList.at(i).rawValue());
+	std::cout << (ok ? "Ok" : "Fail") << " Encoder::decodeAll() decodes in place" << std::endl;
+	std::cout << ((moveCount < legacyCount) ? "Ok" : "Fail") << " Allocations per decoded message (21 varbinds). Copying: " << (legacyCount / loops) << " Moving: " << (moveCount / loops) << std::endl;
+
+	PDUVarbindList list;
+	list.emplace( OID("1.3.6.1.2.1.1.5.0") ).asn1Variable().setOctetString( StdString(64, 'x') );
+	StdString comunity("private");
+	allocationCounter.allocations = 0;
+	PDUVarbind varbind( std::move(list.first()) );
+	list.first() = std::move(varbind);
+	snmp.setupSetRequest( 1, comunity, 1, std::move(list) );
+	Int64 setupCount = allocationCounter.allocations;
+	setDefaultResource(previousResource);
+	std::cout << (((setupCount == 0) && (snmp.varbindList().first().asn1Variable().toStdString() == StdString(64, 'x'))) ? "Ok" : "Fail") << " PDUVarbind(PDUVarbind&&) Encoder::setupSetRequest(PDUVarbindList&&) without allocations" << std::endl;
+	std::cout << std::endl;
+}
+
+void testArenaDecode()
+{
+	Encoder snmpResponce;
+	snmpResponce.setupGetRequest( 1, "public", 1234, OID("1.3.6.1.2.1.2.2.1.2.1") );
+	snmpResponce.setRequestType(ASN1TYPE_ResponcePDU);
+	for( int i = 1; i <= 20; ++i )
+	{
+		ASN1Variable asn1Var;
+		asn1Var.setOctetString( StdString("GigabitEthernet0/") + std::to_string(i) + " uplink to the core switch" );
+		snmpResponce.emplacePDUVar( OID("1.3.6.1.2.1.2.2.1.2." + std::to_string(i)), std::move(asn1Var) );
+	}
+	StdByteVector datagram = snmpResponce.encodeRequest();
+
+	Encoder heapDecoded;
+	heapDecoded.decodeAll(datagram, true);
+
+	MemoryResource *previousResource = setDefaultResource(&allocationCounter);
+	Arena arena;
+	Encoder snmp;
+	const int loops = 1000;
+	allocationCounter.allocations = 0;
+	bool ok = true;
+	for( int i = 0; i < loops; ++i )
+	{
+		ok &= snmp.decodeAll(datagram, true, arena);
+		if( i == 0 )
+			ok &= (snmp.varbindList().count() == 21) && (snmp.requestID() == 1234) && (snmp.comunity() == "public");
+		for( Int64 v = 0; ok && (i == 0) && (v < 21); ++v )
+			ok &= (snmp.varbindList().at(v).oid() == heapDecoded.varbindList().at(v).oid()) &&
+				  (snmp.varbindList().at(v).rawValue() == heapDecoded.varbindList().at(v).rawValue()) &&
+				  (snmp.varbindList().at(v).asn1Variable().toStdString() == heapDecoded.varbindList().at(v).asn1Variable().toStdString());
+		snmp.clearVarbindList();
+		arena.reset();
+	}
+	Int64 arenaCount = allocationCounter.allocations;
+	setDefaultResource(previousResource);
+	std::cout << (ok ? "Ok" : "Fail") << " Encoder::decodeAll(Arena) same as heap decoding" << std::endl;
+	// Only the empty list left by clearVarbindList() is allocated.
+	std::cout << ((arenaCount < 3 * loops) ? "Ok" : "Fail") << " Encoder::decodeAll(Arena) allocations for " << loops << " messages: " << arenaCount << std::endl;
+
+	// Copies don't depend on the arena.
+	snmp.decodeAll(datagram, true, arena);
+	PDUVarbindList copy = snmp.varbindList();
+	snmp.clearVarbindList();
+	arena.reset();
+	snmp.decodeAll(datagram, false);
+	std::cout << (((copy.count() == 21) && (copy.last().asn1Variable().toStdString() == "GigabitEthernet0/20 uplink to the core switch") && (copy.last().resource() == defaultResource()) && (snmp.varbindList().first().resource() == defaultResource())) ? "Ok" : "Fail") << " Arena varbinds copy" << std::endl;
+	std::cout << std::endl;
+}
+
+// Counts the memory taken from it to check who uses which resource.
+
+class IfDescrRow : public TableRowBase<IfDescrRow>
+{
+public:
+	IfDescrRow(int dataId, MemoryResource *resource)
+		: TableRowBase<IfDescrRow>(dataId, resource)
+	{	}
+};
+template<> OID TableBaseInfo<IfDescrRow>::mOIDBase = OID("1.3.6.1.2.1.2.2.1");
+template<> Int64 TableBaseInfo<IfDescrRow>::mKeyCount = 1;
+template<> Int64 TableBaseInfo<IfDescrRow>::mFirstColumn = 1;
+template<> Int64 TableBaseInfo<IfDescrRow>::mLastColumn = 3;
+template<> Int64 TableBaseInfo<IfDescrRow>::mOIDColumnIndex = 9;
+
+void testMemoryResources()
+{
+	Encoder snmpResponce;
+	snmpResponce.setupGetRequest( 1, "public", 1234, OID("1.3.6.1.2.1.2.2.1.1.1") );
+	snmpResponce.setRequestType(ASN1TYPE_ResponcePDU);
+	for( int i = 1; i <= 20; ++i )
+	{
+		ASN1Variable asn1Var;
+		asn1Var.setOctetString( StdString("GigabitEthernet0/") + std::to_string(i) + " uplink to the core switch" );
+		snmpResponce.emplacePDUVar( OID("1.3.6.1.2.1.2.2.1.2." + std::to_string(i)), std::move(asn1Var) );
+	}
+	StdByteVector datagram = snmpResponce.encodeRequest();
+
+	// Long lived table data in one resource, decoding scratch in an arena.
+	CountingResource tableResource;
+	Arena scratch;
+	bool ok = true;
+	{
+		TableBase<IfDescrRow> table(1, &tableResource);
+		Encoder snmp;
+		ok &= snmp.decodeAll(datagram, true, scratch);
+		for( const PDUVarbind &varbind : snmp.varbindList() )
+			ok &= (varbind.resource() == &scratch) && (table.setCellData(varbind) != -1);
+		snmp.clearVarbindList();
+		scratch.reset();
+
+		ok &= (table.count() == 20) && (table.resource() == &tableResource) &&
+			  (table.last().resource() == &tableResource) &&
+			  (table.last().cell(2).resource() == &tableResource) &&
+			  (table.last().cell(2).toStdString() == "GigabitEthernet0/20 uplink to the core switch") &&
+			  (table.last().key(0) == 20);
+		std::cout << (ok ? "Ok" : "Fail") << " TableBase rows, keys and cells from the table resource" << std::endl;
+		std::cout << ((tableResource.allocations > 0) && (tableResource.bytesInUse > 0) ? "Ok" : "Fail") << " TableBase memory taken from the resource: " << tableResource.bytesInUse << " bytes" << std::endl;
+	}
+	std::cout << ((tableResource.bytesInUse == 0) ? "Ok" : "Fail") << " TableBase gives back all the memory" << std::endl;
+
+	// Default resource.
+	CountingResource defaultCounter;
+	MemoryResource *old = setDefaultResource(&defaultCounter);
+	{
+		ASN1Variable asn1Var;
+		asn1Var.setOctetString( StdString(64, 'x') );
+		OID oid("1.3.6.1.2.1.2.2.1.2.1");
+		ok = (asn1Var.resource() == &defaultCounter) && (oid.get_allocator().resource() == &defaultCounter) && (defaultCounter.allocations == 2);
+	}
+	setDefaultResource(old);
+	std::cout << ((ok && (defaultCounter.bytesInUse == 0) && (defaultResource() == old)) ? "Ok" : "Fail") << " setDefaultResource" << std::endl;
+	std::cout << std::endl;
+}
+
+void testTwoPhaseDecode()
+{
+	Encoder snmpResponce;
+	snmpResponce.setupGetRequest( 1, "public", 1234, OID("1.3.6.1.2.1.2.2.1.2.1") );
+	snmpResponce.setRequestType(ASN1TYPE_ResponcePDU);
+	for( int i = 1; i <= 20; ++i )
+	{
+		ASN1Variable asn1Var;
+		if( i % 2 )
+			asn1Var.setOctetString( StdString("GigabitEthernet0/") + std::to_string(i) );
+		else
+			asn1Var.setCounter64( static_cast<UInt64>(i) << 40 );
+		snmpResponce.emplacePDUVar( OID("1.3.6.1.2.1.31.1.1.1." + std::to_string(i)), std::move(asn1Var) );
+	}
+	StdByteVector datagram = snmpResponce.encodeRequest();
+
+	// Same result as the bounds checked decoding.
+	Encoder snmp;
+	PDUVarbindList checked;
+	bool ok = snmp.decodeAll(datagram, true) && legacyDecodeAll(datagram, true, checked) &&
+			  (snmp.requestID() == 1234) && (snmp.comunity() == "public") && (snmp.varbindList().count() == checked.count());
+	for( Int64 v = 0; ok && (v < checked.count()); ++v )
+		ok &= (snmp.varbindList().at(v).oid() == checked.at(v).oid()) &&
+			  (snmp.varbindList().at(v).rawValue() == checked.at(v).rawValue()) &&
+			  (snmp.varbindList().at(v).asn1Variable().type() == checked.at(v).asn1Variable().type()) &&
+			  (snmp.varbindList().at(v).asn1Variable().toStdString() == checked.at(v).asn1Variable().toStdString()) &&
+			  (snmp.varbindList().at(v).asn1Variable().toUInteger() == checked.at(v).asn1Variable().toUInteger());
+	std::cout << (ok ? "Ok" : "Fail") << " Encoder::decodeAll() two phases same as checked decoding" << std::endl;
+
+	// Any truncated datagram is rejected before decoding anything.
+	ok = true;
+	for( Int64 size = 0; size < datagram.count(); ++size )
+		ok &= !snmp.decodeAll( StdByteVector(datagram.chars(), size), true );
+	std::cout << (ok ? "Ok" : "Fail") << " Encoder::decodeAll() rejects truncated datagrams" << std::endl;
+
+	const int loops = 20000;
+	auto t0 = std::chrono::steady_clock::now();
+	for( int i = 0; i < loops; ++i )
+		legacyDecodeAll(datagram, false, checked);
+	auto t1 = std::chrono::steady_clock::now();
+	for( int i = 0; i < loops; ++i )
+		snmp.decodeAll(datagram, false);
+	auto t2 = std::chrono::steady_clock::now();
+	std::cout << "Decoding " << loops << " messages. Checked: " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()
+			  << "us Two phases: " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << "us" << std::endl;
+	std::cout << std::endl;
+}
+
+void testTypeTables()
+{
+	// Compile time tables.
+	static_assert( ASN1TypeSet(ASN1TypePolicies::Numbers())[ASN1TYPE_Counter64], "Counter64 is a number" );
+	static_assert( !ASN1TypeSet(ASN1TypePolicies::MessagePDUs())[ASN1TYPE_TrapPDU], "Trap PDU has another structure" );
+
+	const std::vector<ASN1DataType> numberTypes = { ASN1TYPE_INTEGER, ASN1TYPE_Counter, ASN1TYPE_Counter64, ASN1TYPE_Integer64,
+													 ASN1TYPE_Gauge32, ASN1TYPE_TimeTicks, ASN1TYPE_Unsigned64 };
+	const std::vector<ASN1DataType> requestTypes = { ASN1TYPE_GetRequestPDU, ASN1TYPE_SetRequestPDU, ASN1TYPE_ResponcePDU };
+	bool ok = true;
+	for( int type = 0; type < 256; ++type )
+	{
+		ASN1DataType t = static_cast<ASN1DataType>(type);
+		ok &= (ASN1Encoder::NumberTypes[t] == Utils::contains(numberTypes, t)) &&
+			  (ASN1Encoder::RequestPDUTypes[t] == Utils::contains(requestTypes, t)) &&
+			  (ASN1Encoder::MessagePDUTypes[t] == ((t >= ASN1TYPE_GetRequestPDU) && (t <= ASN1TYPE_ReportPDU) && (t != ASN1TYPE_TrapPDU))) &&
+			  ((ASN1Encoder::ValueKinds[t] == ASN1ValueKind::Number) == Utils::contains(numberTypes, t));
+	}
+	ok &= (ASN1Encoder::ValueKinds[ASN1TYPE_NULL] == ASN1ValueKind::Null) &&
+		  (ASN1Encoder::ValueKinds[ASN1TYPE_OBJECTID] == ASN1ValueKind::ObjectID) &&
+		  (ASN1Encoder::ValueKinds[ASN1TYPE_OCTETSTRING] == ASN1ValueKind::OctetString) &&
+		  (ASN1Encoder::ValueKinds[ASN1TYPE_IPv4Address] == ASN1ValueKind::IPv4Address) &&
+		  (ASN1Encoder::ValueKinds[ASN1TYPE_Opaque] == ASN1ValueKind::Data);
+	std::cout << (ok ? "Ok" : "Fail") << " ASN1 type tables" << std::endl;
+
+	// Stream decoder checks the types with the tables.
+	StdByteVector ba = ASN1Encoder::encodeOctetString( StdString("text") );
+	ASN1Encoder::ErrorCode errorCode = ASN1Encoder::ErrorCode::NoError;
+	Int64 pos = 0;
+	int number;
+	ok = !ASN1Encoder::decodeInteger(errorCode, number, ba, pos, false) && (errorCode == ASN1Encoder::ErrorCode::WrongType);
+	ba = ASN1Encoder::encodeInteger( 1234, ASN1TYPE_Gauge32, true );
+	errorCode = ASN1Encoder::ErrorCode::NoError;
+	pos = 0;
+	ok &= ASN1Encoder::decodeInteger(errorCode, number, ba, pos, false) && (number == 1234);
+	std::cout << (ok ? "Ok" : "Fail") << " ASN1Encoder::decodeInteger() type check" << std::endl;
+	std::cout << std::endl;
+}
+
+void testSharedRawValues()
+{
+	Encoder snmpResponce;
+	snmpResponce.setupGetRequest( 1, "public", 1234, OID("1.3.6.1.2.1.2.2.1.2.1") );
+	snmpResponce.setRequestType(ASN1TYPE_ResponcePDU);
+	for( int i = 1; i <= 20; ++i )
+	{
+		ASN1Variable asn1Var;
+		asn1Var.setOctetString( StdString("GigabitEthernet0/") + std::to_string(i) + " uplink to the core switch" );
+		snmpResponce.emplacePDUVar( OID("1.3.6.1.2.1.2.2.1.2." + std::to_string(i)), std::move(asn1Var) );
+	}
+	StdByteVector encoded = snmpResponce.encodeRequest();
+	Encoder expected;
+	expected.decodeAll(encoded, true);
+
+	// Raw values point into the shared datagram and keep it alive.
+	PDUVarbindList list;
+	{
+		SharedDatagram datagram = std::make_shared<StdByteVector>(encoded);
+		Encoder snmp;
+		bool ok = snmp.decodeAll( MessageView(datagram), true );
+		for( const PDUVarbind &varbind : snmp.varbindList() )
+			ok &= (varbind.rawValue().datagram() == datagram) &&
+				  (varbind.rawValue().bytes() >= datagram->bytes()) &&
+				  (varbind.rawValue().end() <= datagram->bytes() + datagram->count());
+		std::cout << (ok ? "Ok" : "Fail") << " PDUVarbind::rawValue() points into the shared datagram" << std::endl;
+		list = snmp.varbindList();
+	}
+	bool ok = (list.count() == expected.varbindList().count()) && (list.last().rawValue().datagram().use_count() == list.count());
+	for( Int64 i = 0; ok && (i < list.count()); ++i )
+		ok &= (list.at(i).rawValue() == expected.varbindList().at(i).rawValue()) &&
+			  (list.at(i).rawValue().view() == list.at(i).asn1Variable().octetStringView());
+	std::cout << (ok ? "Ok" : "Fail") << " PDUVarbind::rawValue() keeps the datagram alive" << std::endl;
+
+	// Copies of varbinds decoded into an arena get their own bytes.
+	Arena arena;
+	Encoder snmp;
+	snmp.decodeAll(encoded, true, arena);
+	PDUVarbind copy = snmp.varbindList().last();
+	ok = (snmp.varbindList().last().rawValue().datagram()->get_allocator().resource() == &arena) &&
+		 (copy.rawValue().datagram()->get_allocator().resource() == defaultResource()) &&
+		 (copy.rawValue() == snmp.varbindList().last().rawValue());
+	snmp.clearVarbindList();
+	arena.reset();
+	ok &= (copy.rawValue() == expected.varbindList().last().rawValue());
+	std::cout << (ok ? "Ok" : "Fail") << " RawValue copies from an arena" << std::endl;
+	std::cout << std::endl;
+}
+
+void testRecycledDecode()
+{
+	// Same shaped responses with other values, like a poll of ifTable.
+	StdVector<StdByteVector> datagrams;
+	for( int poll = 0; poll < 4; ++poll )
+	{
+		Encoder snmpResponce;
+		snmpResponce.setupGetRequest( 1, "public", 1000 + poll, OID("1.3.6.1.2.1.2.2.1.10.1") );
+		snmpResponce.setRequestType(ASN1TYPE_ResponcePDU);
+		for( int i = 1; i <= 20; ++i )
+		{
+			ASN1Variable asn1Var;
+			if( i % 2 )
+				asn1Var.setOctetString( StdString("GigabitEthernet0/") + std::to_string(i) + " uplink to core " + std::to_string(poll) );
+			else
+				asn1Var.setCounter64( static_cast<UInt64>(poll * 1000 + i) );
+			snmpResponce.emplacePDUVar( OID("1.3.6.1.2.1.31.1.1.1." + std::to_string(i)), std::move(asn1Var) );
+		}
+		datagrams.append( snmpResponce.encodeRequest() );
+	}
+
+	// Receive loop as SNMPConn does it: one buffer and one Encoder for every datagram.
+	MemoryResource *previousResource = setDefaultResource(&allocationCounter);
+	std::shared_ptr<StdByteVector> buffer = std::make_shared<StdByteVector>();
+	Encoder snmp;
+	bool ok = true;
+	const int loops = 1000;
+	for( int i = 0; i < loops; ++i )
+	{
+		if( i == 4 )
+			allocationCounter.allocations = 0;
+		const StdByteVector &received = datagrams[i % 4];
+		snmp.clearRawValues();
+		ok &= buffer.unique();
+		buffer->assign( received.begin(), received.end() );
+		ok &= snmp.decodeAll( MessageView(SharedDatagram(buffer)), true );
+	}
+	Int64 warmCount = allocationCounter.allocations;
+	setDefaultResource(previousResource);
+
+	Encoder expected;
+	expected.decodeAll(datagrams[(loops - 1) % 4], true);
+	ok &= (snmp.requestID() == expected.requestID()) && (snmp.varbindList().count() == expected.varbindList().count());
+	for( Int64 v = 0; ok && (v < expected.varbindList().count()); ++v )
+		ok &= (snmp.varbindList().at(v).oid() == expected.varbindList().at(v).oid()) &&
+			  (snmp.varbindList().at(v).rawValue() == expected.varbindList().at(v).rawValue()) &&
+			  (snmp.varbindList().at(v).asn1Variable().toStdString() == expected.varbindList().at(v).asn1Variable().toStdString()) &&
+			  (snmp.varbindList().at(v).asn1Variable().toUInteger() == expected.varbindList().at(v).asn1Variable().toUInteger());
+	std::cout << (ok ? "Ok" : "Fail") << " Encoder::decodeAll() overwriting the varbinds" << std::endl;
+	std::cout << ((warmCount == 0) ? "Ok" : "Fail") << " Encoder::decodeAll() allocations once warm for " << loops - 4 << " messages: " << warmCount << std::endl;
+
+	// Fewer varbinds drops the remaining ones.
+	Encoder small;
+	small.setupGetRequest( 1, "public", 7, OID("1.3.6.1.2.1.1.5.0") );
+	ok = snmp.decodeAll(small.encodeRequest(), true) && (snmp.varbindList().count() == 1) && (snmp.varbindList().first().oid() == OID("1.3.6.1.2.1.1.5.0"));
+	std::cout << (ok ? "Ok" : "Fail") << " Encoder::decodeAll() smaller message" << std::endl;
+
+	// A broken message leaves nothing of the previous one.
+	StdByteVector truncated = datagrams[0];
+	truncated.resize( truncated.count() - 5 );
+	ok = snmp.decodeAll(datagrams[1], true) && !snmp.decodeAll(truncated, true) &&
+		 (snmp.errorCode() != ASN1Encoder::ErrorCode::NoError) && (snmp.version() == 0) && snmp.comunity().empty() &&
+		 (snmp.requestID() == 0) && (snmp.requestType() == 0) && snmp.varbindList().empty();
+	std::cout << (ok ? "Ok" : "Fail") << " Encoder::decodeAll() truncated message after a valid one" << std::endl;
+	std::cout << std::endl;
+}
+
+// ipNetToMediaTable like: ifIndex and IPv4 address as keys.
+class ArpRow : public TableRowBase<ArpRow>
+{
+public:
+	ArpRow(int dataId)
+		: TableRowBase<ArpRow>(dataId)
+	{	}
+};
+template<> OID TableBaseInfo<ArpRow>::mOIDBase = OID("1.3.6.1.2.1.4.22.1");
+template<> Int64 TableBaseInfo<ArpRow>::mKeyCount = 5;
+template<> Int64 TableBaseInfo<ArpRow>::mFirstColumn = 1;
+template<> Int64 TableBaseInfo<ArpRow>::mLastColumn = 4;
+template<> Int64 TableBaseInfo<ArpRow>::mOIDColumnIndex = 9;
+
+// OID of a cell of the ArpRow table. The row number goes in the last three
+// keys; the first one cycles from 1 to 4, so rows aren't added in key order.
+static OID arpOID(int column, int row)
+{
+	OID oid("1.3.6.1.2.1.4.22.1");
+	for( int arc : { column, 1 + row % 4, 10, (row >> 16) & 0xFF, (row >> 8) & 0xFF, row & 0xFF } )
+		oid.append( OIDValue(arc) );
+	return oid;
+}
+
+void testTableKeyIndex()
+{
+	const int rows = 20000;
+	TableBase<ArpRow> table(1);
+	ASN1Variable asn1Var;
+	bool ok = true;
+	auto t0 = std::chrono::steady_clock::now();
+	for( int column = 1; column <= 4; ++column )
+	{
+		for( int row = 0; row < rows; ++row )
+		{
+			asn1Var.setInteger(row * 10 + column);
+			ok &= (table.setCellData( PDUVarbind(arpOID(column, row), asn1Var) ) == row);
+		}
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	ok &= (table.count() == rows) && (table.at(1234).cell(3).toInteger() == 12343);
+	std::cout << (ok ? "Ok" : "Fail") << " TableBase::setCellData() " << rows << " rows x 4 columns in "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count() << "ms" << std::endl;
+
+	// Removing rows moves up the next ones in the index.
+	table.removeRow(0);
+	table.removeRow( PDUVarbind(arpOID(1, 5000)) );
+	ok = (table.count() == rows - 2) &&
+		 (table.rowOf(arpOID(2, 0)) == -1) &&
+		 (table.rowOf(arpOID(2, 1)) == 0) &&
+		 (table.rowOf(arpOID(2, 4999)) == 4998) &&
+		 (table.rowOf(arpOID(2, 5000)) == -1) &&
+		 (table.rowOf(arpOID(2, 5001)) == 4999) &&
+		 (table.rowOf(PDUVarbind(arpOID(3, rows - 1))) == rows - 3) &&
+		 (table.rowOf(OID("1.3.6.1.2.1.4.22.1.1.9.10.0.0.1")) == -1);
+	std::cout << (ok ? "Ok" : "Fail") << " TableBase::rowOf() after removeRow()" << std::endl;
+
+	// Per key position index.
+	ok = (table.keyRow(0, OIDValue(1)) == 3) && (table.keyRow(0, OIDValue(2)) == 0) && (table.keyRow(0, OIDValue(5)) == -1) &&
+		 (table.keyRow(4, OIDValue(7)) == 6) && (table.newSequencialKeyRowValue<UInt64>(0) == 5);
+	std::cout << (ok ? "Ok" : "Fail") << " TableBase::keyRow()" << std::endl;
+
+	// Rows added directly to the deque get indexed too.
+	table.append( ArpRow(1) );
+	table.last().key(0) = OIDValue(9);
+	ok = (table.rowOf(OID("1.3.6.1.2.1.4.22.1.1.9.0.0.0.0")) == table.count() - 1);
+	// Keys set through setKey() are indexed and sorted at once.
+	table.setKey( table.count() - 1, 1, OIDValue(10) );
+	ok &= (table.rowOf(OID("1.3.6.1.2.1.4.22.1.1.9.10.0.0.0")) == table.count() - 1) &&
+		  (table.rowOf(OID("1.3.6.1.2.1.4.22.1.1.9.0.0.0.0")) == -1) && (table.nextRow(OID("9.9")) == table.count() - 1);
+	// Keys changed directly, once indexes are invalidated or rebuilt.
+	table.last().key(2) = OIDValue(11);
+	table.invalidateIndexes();
+	ok &= (table.rowOf(OID("1.3.6.1.2.1.4.22.1.1.9.10.11.0.0")) == table.count() - 1);
+	table.last().key(3) = OIDValue(12);
+	table.reindex();
+	table.updateIndexes();
+	ok &= (table.rowOf(OID("1.3.6.1.2.1.4.22.1.1.9.10.11.12.0")) == table.count() - 1) && (table.nextRow(OID("9.10.11")) == table.count() - 1);
+	std::cout << (ok ? "Ok" : "Fail") << " TableBase::reindex()" << std::endl;
+	std::cout << std::endl;
+}
+
+void testTableValueIndex()
+{
+	const int rows = 20000;
+	TableBase<ArpRow> table(1);
+	table.indexColumn(1);
+	table.indexColumn(2);
+	ASN1Variable asn1Var;
+	for( int row = 0; row < 5000; ++row )
+	{
+		asn1Var.setInteger(row + 1);
+		table.setCellData( PDUVarbind(arpOID(1, row), asn1Var) );
+		asn1Var.setOctetString( "host" + std::to_string(row) );
+		table.setCellData( PDUVarbind(arpOID(2, row), asn1Var) );
+		asn1Var.setInteger(row % 7);
+		table.setCellData( PDUVarbind(arpOID(3, row), asn1Var) );
+	}
+	bool ok = table.isColumnIndexed(1) && !table.isColumnIndexed(3) &&
+			  (table.findCellRow(1, 1234) == 1233) && (table.findCellRow(1, 0) == -1) &&
+			  (table.findCellRow(2, "host4321") == 4321) && (table.findCellRow(2, "nohost") == -1) &&
+			  (table.findCellRow(3, 3) == 3) && (table.newCellRowValue(1) == 5001) &&
+			  (table.newCellRowValue(2, "host") == "host5000");
+
+	// Removed rows and changed cells free its values.
+	table.removeRow(99);
+	ok &= (table.newCellRowValue(1) == 100) && (table.findCellRow(1, 101) == 99) && (table.findCellRow(2, "host100") == 99);
+	asn1Var.setInteger(100);
+	table.setCellData( PDUVarbind(arpOID(1, 0), asn1Var) );
+	ok &= (table.findCellRow(1, 1) == -1) && (table.findCellRow(1, 100) == 0) && (table.newCellRowValue(1) == 1);
+	std::cout << (ok ? "Ok" : "Fail") << " TableBase::findCellRow() on indexed columns" << std::endl;
+
+	// Unique values for new rows without scanning the table.
+	auto t0 = std::chrono::steady_clock::now();
+	for( int row = 5000; row < rows; ++row )
+	{
+		asn1Var.setInteger( table.newCellRowValue(1) );
+		table.setCellData( PDUVarbind(arpOID(1, row), asn1Var) );
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	ok = (table.count() == rows - 1) && (table.newCellRowValue(1) == rows) &&
+		 (table.findCellRow(1, 1) == table.rowOf(arpOID(1, 5000))) && (table.findCellRow(1, 5001) == table.rowOf(arpOID(1, 5001)));
+	table.reindex();
+	ok &= (table.findCellRow(1, rows - 1) == table.count() - 1) && (table.findCellRow(2, "host4999") == 4998);
+	std::cout << (ok ? "Ok" : "Fail") << " TableBase::newCellRowValue() for " << rows - 5000 << " new rows in "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count() << "ms" << std::endl;
+	std::cout << std::endl;
+}
+
+void testColumnTable()
+{
+	const int rows = 100000;
+	TableBase<ArpRow> rowTable(1);
+	ColumnTable<ArpRow> columnTable(1);
+	ASN1Variable asn1Var;
+	for( int row = 0; row < rows; ++row )
+	{
+		for( int column = 1; column <= 4; ++column )
+		{
+			switch( column )
+			{
+			case 1: asn1Var.setInteger(row);	break;
+			case 2: asn1Var.setOctetString( "host" + std::to_string(row % 100) );	break;
+			case 3: asn1Var.setCounter64( 1000ull * static_cast<UInt64>(row) );	break;
+			case 4: asn1Var.setIPv4( 10, 0, static_cast<unsigned char>(row >> 8), static_cast<unsigned char>(row) );	break;
+			}
+			// Cells of another type than the column one are kept too.
+			if( (column == 4) && (row == 7) )
+				asn1Var.setOctetString("none");
+			if( (column == 1) && (row == 8) )
+				continue;
+			rowTable.setCellData( PDUVarbind(arpOID(column, row), asn1Var) );
+			columnTable.setCellData( PDUVarbind(arpOID(column, row), asn1Var) );
+		}
+	}
+	bool ok = (columnTable.count() == rowTable.count()) &&
+			  (columnTable.column(1).type() == ASN1TYPE_INTEGER) && (columnTable.column(2).kind() == TableColumn::Strings) &&
+			  (columnTable.column(4).type() == ASN1TYPE_IPv4Address) && !columnTable.column(4).isValid(7) && columnTable.column(4).hasValue(7) &&
+			  !columnTable.column(1).hasValue(8) && (columnTable.column(2).string(1234) == ByteView(StdByteVector("host34")));
+	for( int row = 0; ok && (row < rows); row += 97 )
+	{
+		ok &= (columnTable.rowOf(arpOID(1, row)) == row) && (columnTable.at(row).keys() == rowTable.at(row).keys());
+		for( int column = 1; column <= 4; ++column )
+		{
+			ASN1Variable a = columnTable.at(row).cell(column);
+			const ASN1Variable &b = rowTable.at(row).cell(column);
+			ok &= (a.type() == b.type()) && (a.toUInteger() == b.toUInteger()) && (a.octetStringView() == b.octetStringView()) &&
+				  (columnTable.at(row).cellOID(column) == rowTable.at(row).cellOID(column));
+		}
+	}
+	ok &= (columnTable.at(7).cell(4).toStdString() == "none") && (columnTable.at(8).cell(1).type() == ASN1TYPE_NULL);
+	std::cout << (ok ? "Ok" : "Fail") << " ColumnTable cells" << std::endl;
+
+	// Adding up a column.
+	auto t0 = std::chrono::steady_clock::now();
+	UInt64 rowSum = 0;
+	for( int row = 0; row < rowTable.count(); ++row )
+		rowSum += rowTable.at(row).cell(3).toUInteger();
+	auto t1 = std::chrono::steady_clock::now();
+	UInt64 columnSum = columnTable.column(3).sum();
+	auto t2 = std::chrono::steady_clock::now();
+	ok = (rowSum == columnSum) && (columnSum == 1000ull * (static_cast<UInt64>(rows) * (rows - 1) / 2));
+	std::cout << (ok ? "Ok" : "Fail") << " ColumnTable::column().sum() of " << rows << " rows in "
+			  << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << "us, by rows in "
+			  << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << "us" << std::endl;
+
+	// Removing rows moves up the next ones.
+	columnTable.removeRow(0);
+	columnTable.removeRow( PDUVarbind(arpOID(1, 5)) );
+	ok = (columnTable.count() == rows - 2) && (columnTable.rowOf(arpOID(1, 0)) == -1) &&
+		 (columnTable.rowOf(arpOID(1, 6)) == 4) && (columnTable.at(4).cell(1).toInteger() == 6) &&
+		 (columnTable.at(5).cell(4).toStdString() == "none") && !columnTable.column(1).hasValue(6) &&
+		 (columnTable.column(3).sum() == columnSum - 5000) && (columnTable.keyRow(0, OIDValue(2)) == 0);
+	std::cout << (ok ? "Ok" : "Fail") << " ColumnTable::removeRow()" << std::endl;
+
+	// Strings no row uses are freed and its ids reused.
+	ColumnTable<ArpRow> names(1);
+	for( int row = 0; row < 10; ++row )
+	{
+		asn1Var.setOctetString( "name" + std::to_string(row % 5) );
+		names.setCellData( PDUVarbind(arpOID(2, row), asn1Var) );
+	}
+	ok = (names.column(2).stringCount() == 5);
+	names.removeRow( PDUVarbind(arpOID(2, 0)) );
+	ok &= (names.column(2).stringCount() == 5);
+	names.removeRow( PDUVarbind(arpOID(2, 5)) );
+	ok &= (names.column(2).stringCount() == 4);
+	asn1Var.setOctetString("name1");
+	names.setCellData( PDUVarbind(arpOID(2, 1), asn1Var) );
+	asn1Var.setOctetString("other");
+	names.setCellData( PDUVarbind(arpOID(2, 1), asn1Var) );
+	names.setCellData( PDUVarbind(arpOID(2, 6), asn1Var) );
+	ok &= (names.column(2).stringCount() == 4) && (names.at(names.rowOf(arpOID(2, 6))).cell(2).toStdString() == "other") &&
+		  (names.at(names.rowOf(arpOID(2, 2))).cell(2).toStdString() == "name2");
+	asn1Var.setInteger(3);
+	names.setCellData( PDUVarbind(arpOID(2, 3), asn1Var) );
+	names.setCellData( PDUVarbind(arpOID(2, 8), asn1Var) );
+	ok &= (names.column(2).stringCount() == 3) && (names.at(names.rowOf(arpOID(2, 8))).cell(2).toInteger() == 3);
+	names.clear();
+	ok &= (names.column(2).stringCount() == 0);
+	std::cout << (ok ? "Ok" : "Fail") << " TableColumn interned strings released" << std::endl;
+	std::cout << std::endl;
+}
+
+void testTableKeyOrder()
+{
+	const int rows = 20000;
+	auto keysLess = [](const OID &a, const OID &b)
+	{
+		return std::lexicographical_compare( a.begin(), a.end(), b.begin(), b.end(),
+											 [](const OIDValue &x, const OIDValue &y) { return x.toULongLong() < y.toULongLong(); } );
+	};
+	TableBase<ArpRow> table(1);
+	ColumnTable<ArpRow> columnTable(1);
+	ASN1Variable asn1Var;
+	// Rows arrive out of order and queries come in between.
+	bool ok = true;
+	for( int i = 0; i < rows; ++i )
+	{
+		int row = (i * 7919) % rows;
+		asn1Var.setInteger(row);
+		table.setCellData( PDUVarbind(arpOID(1, row), asn1Var) );
+		columnTable.setCellData( PDUVarbind(arpOID(1, row), asn1Var) );
+		if( i == rows / 2 )
+			ok &= (table.orderedRows().count() == i + 1) && (columnTable.orderedRows().count() == i + 1);
+	}
+	const StdVector<Int64> &ordered = table.orderedRows();
+	ok &= (ordered.count() == rows) && (columnTable.orderedRows().count() == rows);
+	for( Int64 i = 1; ok && (i < ordered.count()); ++i )
+		ok &= keysLess( table.at(ordered[i-1]).keys(), table.at(ordered[i]).keys() ) &&
+			  (columnTable.at(columnTable.orderedRows()[i]).keys() == table.at(ordered[i]).keys());
+	std::cout << (ok ? "Ok" : "Fail") << " TableBase::orderedRows()" << std::endl;
+
+	// GetNext order.
+	ok = (table.nextRow(OID()) == ordered.front()) &&
+		 (table.nextRow(table.at(ordered[10]).keys()) == ordered[11]) &&
+		 (table.nextRow(table.at(ordered.back()).keys()) == -1) &&
+		 (table.at(table.nextRow(OID("2"))).keys() == OID("2.10.0.0.1")) &&
+		 (table.at(table.nextRow(OID("2.10.0.0.1"))).keys() == OID("2.10.0.0.5")) &&
+		 (table.at(table.nextRow(OID("2.10.0.0.2"))).keys() == OID("2.10.0.0.5")) &&
+		 (columnTable.at(columnTable.nextRow(OID("3.10.0.0.2"))).keys() == OID("3.10.0.0.6"));
+	std::cout << (ok ? "Ok" : "Fail") << " TableBase::nextRow()" << std::endl;
+
+	// Key prefix ranges.
+	std::pair<Int64, Int64> range = table.keyRange( OID("3.10") );
+	ok = (range.second - range.first == rows / 4) && (table.at(ordered[range.first]).key(0).toULongLong() == 3) &&
+		 (table.at(ordered[range.second - 1]).key(0).toULongLong() == 3) && (table.at(ordered[range.second]).key(0).toULongLong() == 4);
+	range = table.keyRange( OID("1.10.0.1") );
+	ok &= (range.second - range.first == 64) && (columnTable.keyRange(OID("1.10.0.1")) == range);
+	ok &= (table.keyRange(OID("1.11")).second == table.keyRange(OID("1.11")).first) &&
+		  (table.keyRange(OID()) == std::make_pair(Int64(0), Int64(rows))) &&
+		  (table.keyRange(OID("1.10.0.0.0.7")).second == table.keyRange(OID("1.10.0.0.0.7")).first);
+
+	// Removing rows keeps the order.
+	Int64 removed = table.rowOf( arpOID(1, 5) );
+	table.removeRow(removed);
+	columnTable.removeRow( PDUVarbind(arpOID(1, 5)) );
+	ok &= (table.orderedRows().count() == rows - 1) &&
+		  (table.at(table.nextRow(OID("2.10.0.0.1"))).keys() == OID("2.10.0.0.9")) &&
+		  (columnTable.at(columnTable.nextRow(OID("2.10.0.0.1"))).keys() == OID("2.10.0.0.9"));
+	std::cout << (ok ? "Ok" : "Fail") << " TableBase::keyRange()" << std::endl;
+	std::cout << std::endl;
+}
+
+void testTableIngest()
+{
+	const int rows = 20000;
+	// As GetBulk responses bring them: every column of a row, row after row.
+	StdVector<PDUVarbind> varbinds;
+	ASN1Variable asn1Var;
+	for( int row = 0; row < rows; ++row )
+	{
+		for( int column = 1; column <= 4; ++column )
+		{
+			asn1Var.setInteger(row * 10 + column);
+			varbinds.append( PDUVarbind(arpOID(column, row), asn1Var) );
+		}
+	}
+	TableBase<ArpRow> expected(1);
+	for( const PDUVarbind &varbind : varbinds )
+		expected.setCellData(varbind);
+
+	TableBase<ArpRow> table(1);
+	table.indexColumn(1);
+	auto t0 = std::chrono::steady_clock::now();
+	StdVector<IngestOutcome> outcomes = table.ingest(varbinds);
+	auto t1 = std::chrono::steady_clock::now();
+	bool ok = (outcomes.count() == varbinds.count()) && (table.count() == expected.count());
+	for( Int64 i = 0; ok && (i < outcomes.count()); ++i )
+		ok &= (outcomes[i].row == i / 4) && (outcomes[i].result == ((i % 4) ? IngestOutcome::Updated : IngestOutcome::Added));
+	for( Int64 row = 0; ok && (row < table.count()); ++row )
+	{
+		ok &= (table.at(row).keys() == expected.at(row).keys());
+		for( int column = 1; column <= 4; ++column )
+			ok &= (table.at(row).cell(column).toInteger() == expected.at(row).cell(column).toInteger());
+	}
+	ok &= (table.findCellRow(1, 12341) == 1234) && (table.rowOf(arpOID(2, 777)) == 777);
+	std::cout << (ok ? "Ok" : "Fail") << " TableBase::ingest() of " << varbinds.count() << " varbinds in "
+			  << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count() << "ms" << std::endl;
+
+	// Varbinds not for the table are reported, not stored.
+	PDUVarbindList mixed;
+	asn1Var.setInteger(1);
+	mixed.append( PDUVarbind(OID("1.3.6.1.2.1.1.3.0"), asn1Var) );
+	mixed.append( PDUVarbind(OID("1.3.6.1.2.1.4.22.1"), asn1Var) );
+	mixed.append( PDUVarbind(arpOID(5, 3), asn1Var) );
+	mixed.append( PDUVarbind(OID("1.3.6.1.2.1.4.22.1.1.1.10.0.0"), asn1Var) );
+	mixed.append( PDUVarbind(arpOID(3, 3), asn1Var) );
+	mixed.append( PDUVarbind(arpOID(3, rows), asn1Var) );
+	outcomes = table.ingest(mixed);
+	ok = (outcomes.count() == 6) &&
+		 (outcomes[0].result == IngestOutcome::NotInTable) && (outcomes[0].row == -1) &&
+		 (outcomes[1].result == IngestOutcome::NotInTable) &&
+		 (outcomes[2].result == IngestOutcome::BadColumn) &&
+		 (outcomes[3].result == IngestOutcome::BadKeys) &&
+		 (outcomes[4].result == IngestOutcome::Updated) && (outcomes[4].row == 3) && (table.at(3).cell(3).toInteger() == 1) &&
+		 (outcomes[5].result == IngestOutcome::Added) && (outcomes[5].row == rows) && (table.count() == rows + 1);
+	std::cout << (ok ? "Ok" : "Fail") << " TableBase::ingest() outcomes" << std::endl;
+	std::cout << std::endl;
+}
+
+void testTableChanges()
+{
+	const int rows = 1000;
+	// A walk of the table. Every row value changes with the walk number.
+	auto walk = [&](int walkNumber, int firstRow, int lastRow)
+	{
+		StdVector<PDUVarbind> varbinds;
+		ASN1Variable asn1Var;
+		for( int row = firstRow; row < lastRow; ++row )
+		{
+			for( int column = 1; column <= 4; ++column )
+			{
+				asn1Var.setInteger( ((column == 3) && !(row % 100)) ? row * walkNumber : row );
+				varbinds.append( PDUVarbind(arpOID(column, row), asn1Var) );
+			}
+		}
+		return varbinds;
+	};
+	TableBase<ArpRow> table(1);
+	table.ingest( walk(1, 0, rows) );
+	UInt64 first = table.generation();
+	TableChanges changes = table.changesSince(0);
+	bool ok = (first > 0) && (changes.addedRows.count() == rows) && changes.removedKeys.isEmpty() && changes.changedCells.isEmpty() &&
+			  table.changesSince(first).isEmpty();
+
+	// Same values don't make changes.
+	table.ingest( walk(1, 0, rows) );
+	ok &= (table.generation() == first) && table.changesSince(first).isEmpty();
+
+	// A new walk misses rows 0 to 9 and brings rows 1000 to 1004.
+	table.indexColumn(3);
+	table.beginRefresh();
+	table.ingest( walk(2, 10, rows + 5) );
+	ok &= (table.endRefresh() == 10) && (table.count() == rows - 5);
+	ok &= (table.rowOf(arpOID(1, 9)) == -1) && (table.rowOf(arpOID(1, 10)) == 0) && (table.rowOf(arpOID(1, 1004)) == rows - 6) &&
+		  (table.findCellRow(3, 501) == 491) && (table.findCellRow(3, 5) == -1) && (table.orderedRows().count() == rows - 5) &&
+		  (table.nextRow(OID("1.10.0.0.8")) == table.rowOf(arpOID(1, 12)));
+	changes = table.changesSince(first);
+	ok &= (changes.addedRows.count() == 5) && (table.at(changes.addedRows[0]).keys() == OID("1.10.0.3.232")) &&
+		  (changes.removedKeys.count() == 10) && (changes.removedKeys[0] == OID("1.10.0.0.0")) && (changes.removedKeys[9] == OID("2.10.0.0.9")) &&
+		  (changes.changedCells.count() == 9) && (changes.changedCells[0] == std::make_pair(Int64(90), Int64(3))) &&
+		  (table.at(90).cell(3).toInteger() == 200);
+
+	// Changes since a later generation and forgotten removals.
+	UInt64 second = table.generation();
+	table.removeRow( PDUVarbind(arpOID(1, 500)) );
+	ok &= (table.changesSince(second).removedKeys.count() == 1) && (table.changesSince(first).removedKeys.count() == 11);
+	table.forgetChanges(second);
+	ok &= (table.changesSince(first).removedKeys.count() == 1);
+
+	// A key change is the row with the old keys removed and the one with the new keys added.
+	UInt64 third = table.generation();
+	Int64 rekeyed = table.rowOf( arpOID(1, 600) );
+	OID oldKeys = table.at(rekeyed).keys();
+	table.setKey( rekeyed, 2, OIDValue(99) );
+	table.setKey( rekeyed, 2, OIDValue(99) );
+	changes = table.changesSince(third);
+	ok &= (changes.removedKeys.count() == 1) && (changes.removedKeys[0] == oldKeys) &&
+		  (changes.addedRows.count() == 1) && (changes.addedRows[0] == rekeyed) && changes.changedCells.isEmpty() &&
+		  (table.at(rekeyed).key(2) == 99);
+	std::cout << (ok ? "Ok" : "Fail") << " TableBase::changesSince()" << std::endl;
+	std::cout << std::endl;
+}
+
+void testSnapshots()
+{
+	const int rows = 5000;
+	TableBase<ArpRow> table(1);
+	ASN1Variable asn1Var;
+	for( int row = rows - 1; row >= 0; --row )
+	{
+		asn1Var.setInteger(-row);
+		table.setCellData( PDUVarbind(arpOID(1, row), asn1Var) );
+		asn1Var.setOctetString( (row % 10) ? "eth" + std::to_string(row % 10) : StdString(40, 'x') );
+		table.setCellData( PDUVarbind(arpOID(2, row), asn1Var) );
+		if( row % 3 )
+			asn1Var.setIPv4( 10, 0, static_cast<unsigned char>(row >> 8), static_cast<unsigned char>(row) );
+		else
+			asn1Var.setOID( OID("1.3.6.1.4.1.9.1") );
+		table.setCellData( PDUVarbind(arpOID(3, row), asn1Var) );
+		// Column 4 stays null.
+	}
+	StdByteVector bytes = tableSnapshot(table);
+	SnapshotView snapshot;
+	auto t0 = std::chrono::steady_clock::now();
+	bool ok = snapshot.load( bytes.bytes(), bytes.count() );
+	auto t1 = std::chrono::steady_clock::now();
+	ok &= (snapshot.kind() == SnapshotKind::Table) && (snapshot.rowCount() == rows) && (snapshot.keyCount() == 5) &&
+		  (snapshot.columnCount() == 4) && (snapshot.baseOID() == table.oidBase()) &&
+		  (snapshot.columnType(0) == ASN1TYPE_INTEGER) && (snapshot.columnType(2) == ASN1TYPE_OBJECTID) && (snapshot.columnType(3) == ASN1TYPE_NULL);
+	// Rows are in key order and strings are interned.
+	const StdVector<Int64> &ordered = table.orderedRows();
+	for( Int64 i = 0; ok && (i < rows); ++i )
+	{
+		ok &= (snapshot.keys(i) == table.at(ordered[i]).keys()) && (snapshot.findRow(snapshot.keys(i)) == i);
+		for( Int64 c = 0; c < 4; ++c )
+			ok &= (snapshot.cell(i, c) == table.at(ordered[i]).cell(1 + c));
+	}
+	ok &= (snapshot.findRow(OID("9.9.9.9.9")) == -1) && (snapshot.string(1000).isEmpty()) && (bytes.count() < rows * 4 * 24);
+	std::cout << (ok ? "Ok" : "Fail") << " tableSnapshot() of " << rows << " rows in " << bytes.count() << " bytes, loaded in "
+			  << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << "us" << std::endl;
+
+	// Broken snapshots are not loaded.
+	SnapshotView broken;
+	StdByteVector bad = bytes;
+	bad[0] = 'X';
+	ok = !broken.load( bad.bytes(), bad.count() ) && !broken.isValid() &&
+		 !broken.load( bytes.bytes(), bytes.count() - 1 ) &&
+		 !broken.load( bytes.bytes(), 16 );
+	bad = bytes;
+	reinterpret_cast<SnapshotHeader*>(bad.data())->rowCount = UInt64(1) << 62;
+	ok &= !broken.load( bad.bytes(), bad.count() );
+	bad = bytes;
+	reinterpret_cast<SnapshotHeader*>(bad.data())->stringsOffset = static_cast<UInt64>(bad.count());
+	ok &= !broken.load( bad.bytes(), bad.count() );
+	std::cout << (ok ? "Ok" : "Fail") << " SnapshotView::load() of broken snapshots" << std::endl;
+
+	// Restored tables are refreshed as usual.
+	TableBase<ArpRow> restored(1);
+	ok = restoreTable(snapshot, restored) && (restored.count() == rows);
+	for( Int64 row = 0; ok && (row < rows); row += 7 )
+	{
+		Int64 original = table.rowOf( restored.at(row).keys() );
+		for( Int64 col = 1; col <= 4; ++col )
+			ok &= (restored.at(row).cell(col) == table.at(original).cell(col));
+	}
+	UInt64 generation = restored.generation();
+	restored.beginRefresh();
+	restored.ingest( table.at(0).varbindList(Int64(-1)) );
+	ok &= (restored.endRefresh() == rows - 1) && restored.changesSince(generation).changedCells.isEmpty() &&
+		  !restoreTable( SnapshotView(), restored );
+	std::cout << (ok ? "Ok" : "Fail") << " restoreTable()" << std::endl;
+
+	// Varbind lists.
+	PDUVarbindList varbinds;
+	for( Int64 row = 0; row < 4; ++row )
+		varbinds.append( table.at(row).varbind(2 + row % 2) );
+	varbinds.append( PDUVarbind(OID("1.3.6.1.2.1.1.3.0")) );
+	bytes = varbindListSnapshot(varbinds);
+	ok = snapshot.load( bytes.bytes(), bytes.count() ) && (snapshot.kind() == SnapshotKind::VarbindList);
+	PDUVarbindList loaded = snapshot.varbindList();
+	ok &= (loaded.count() == varbinds.count());
+	for( Int64 i = 0; ok && (i < loaded.count()); ++i )
+		ok &= (loaded[i].oid() == varbinds[i].oid()) && (loaded[i].asn1Variable() == varbinds[i].asn1Variable());
+	std::cout << (ok ? "Ok" : "Fail") << " varbindListSnapshot()" << std::endl;
+	std::cout << std::endl;
+}
+
 void SNMPTests::doTests()
 {
 	testIntegers();
@@ -208,4 +1520,29 @@ void SNMPTests::doTests()
 	testOIDs();
 	testNULLs();
 	testSNMPRequest();
+	testSNMPRequestWriter();
+	testSNMPRequestInto();
+	testRequestTemplate();
+	testMessageView();
+	testLazyVarbinds();
+	testCompactOID();
+	testOIDParse();
+	testTextWriter();
+	testOIDRegistry();
+	testVarbindDispatcher();
+	testASN1VariableStorage();
+	testMoveSemantics();
+	testArenaDecode();
+	testMemoryResources();
+	testTwoPhaseDecode();
+	testTypeTables();
+	testSharedRawValues();
+	testRecycledDecode();
+	testTableKeyIndex();
+	testTableValueIndex();
+	testColumnTable();
+	testTableKeyOrder();
+	testTableIngest();
+	testTableChanges();
+	testSnapshots();
 }
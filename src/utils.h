@@ -130,34 +130,79 @@ namespace Utils {
 		return rtn;
 	}
 
-	template <typename T>
-	StdString printableBytes(const T &vector, const StdString &sep = "")
+	// Formatting functions that append to an output buffer.
+	// No temporaries are created, so they can be used to log or export
+	// lots of data reusing the same buffer.
+
+	// Writes the digits backwards ending at bufferEnd. Returns the first digit.
+	// Buffer must have room for 20 chars.
+	inline char *formatUnsigned(UInt64 value, char *bufferEnd)
 	{
-		typename T::size_type vectorSize = vector.size();
-		if( vectorSize == 0 )
-			return StdString();
-		typename T::size_type separatorSize = sep.size();
-		StdString::size_type totalSize = (vectorSize << 1) + (separatorSize * (vectorSize - 1));
-		StdString rtn( totalSize, '0' );
-
-		UInt32 vIndex = 0;
-		UInt32 outIndex = 0;
 		do
 		{
-			rtn[outIndex++] = _hexChar( (vector[vIndex] >> 4) & 0xF );
-			rtn[outIndex++] = _hexChar( vector[vIndex++] & 0xF );
-			if( (vIndex != vectorSize) && (separatorSize != 0) )
-			{
-				rtn.replace( outIndex, separatorSize, sep );
-				outIndex += separatorSize;
-			}
+			*--bufferEnd = static_cast<char>('0' + (value % 10));
+			value /= 10;
+		}
+		while( value != 0 );
+		return bufferEnd;
+	}
+	inline void appendUnsigned(StdString &out, UInt64 value)
+	{
+		char buffer[20];
+		char *end = buffer + sizeof(buffer);
+		char *begin = formatUnsigned(value, end);
+		out.append( begin, static_cast<StdString::size_type>(end - begin) );
+	}
+	inline void appendInteger(StdString &out, Int64 value)
+	{
+		if( value < 0 )
+		{
+			out.push_back('-');
+			appendUnsigned( out, static_cast<UInt64>(0) - static_cast<UInt64>(value) );
+		}
+		else
+			appendUnsigned( out, static_cast<UInt64>(value) );
+	}
+	inline void appendHexBytes(StdString &out, const Byte *bytes, Int64 count, const char *sep = "", StdString::size_type sepSize = 0)
+	{
+		if( count <= 0 )
+			return;
+		out.reserve( out.size() + static_cast<StdString::size_type>(count) * (2 + sepSize) );
+		for( Int64 i = 0; i < count; ++i )
+		{
+			if( (i != 0) && (sepSize != 0) )
+				out.append( sep, sepSize );
+			out.push_back( _hexChar( (bytes[i] >> 4) & 0xF ) );
+			out.push_back( _hexChar( bytes[i] & 0xF ) );
 		}
-		while( vIndex < vectorSize );
+	}
+	inline void appendIPv4Address(StdString &out, const IPv4Address &ipv4, char sep = '.')
+	{
+		appendUnsigned( out, ipv4.octetA() );
+		out.push_back( sep );
+		appendUnsigned( out, ipv4.octetB() );
+		out.push_back( sep );
+		appendUnsigned( out, ipv4.octetC() );
+		out.push_back( sep );
+		appendUnsigned( out, ipv4.octetD() );
+	}
 
+	template <typename T>
+	StdString printableBytes(const T &vector, const StdString &sep = "")
+	{
+		StdString rtn;
+		if( vector.size() != 0 )
+			appendHexBytes( rtn, vector.data(), static_cast<Int64>(vector.size()), sep.data(), sep.size() );
 		return rtn;
 	}
 	inline StdString ipv4AddressToStdString(const IPv4Address &ipv4, const StdString &sep = ".")
 	{
+		if( sep.size() == 1 )
+		{
+			StdString rtn;
+			appendIPv4Address( rtn, ipv4, sep[0] );
+			return rtn;
+		}
 		return std::to_string( ipv4.octetA() ) + sep +
 			   std::to_string( ipv4.octetB() ) + sep +
 			   std::to_string( ipv4.octetC() ) + sep +